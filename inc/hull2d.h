@@ -3,45 +3,164 @@
 
 #include "defines.h"
 #include "stack.h"
+#include "pool.h"
 #include "qsort.h"
 
 #define MAX_POINTS_PER_HULL   (MAX_BLOBS_PER_GROUP * CORNERS_PER_BLOB)
 
+// Floats in each vertex array of a hull of capacity points, room for the
+// repeated first vertex rounded up to keep both arrays 16 byte aligned
+#define HULL2D_VERTEX_STRIDE(capacity) (((size_t)(capacity) + 4U) & ~(size_t)3U)
+
+// Bytes of storage needed by hull2d_initBuffer for a hull of capacity points
+#define HULL2D_BUFFER_SIZE(capacity) \
+    ((size_t)(capacity) * (sizeof(Point2f) + sizeof(flaggedindex_t)) + \
+     2U * HULL2D_VERTEX_STRIDE(capacity) * sizeof(float))
+
+// Number of directions the extreme points of a hull are kept for
+#define HULL2D_DIRECTIONS     (8)
+
+// Packed into 32 bits so sorts, swaps and the scratch stack move 4 bytes per
+// index, the flag takes the top bit
 typedef struct flaggedindex_s
 {
-    uint32_t pointIdx;
-    bool_t   remove;
+    uint32_t pointIdx : 31;
+    uint32_t remove   : 1;
 } flaggedindex_t;
 
+// Typed stack of boundary indices, the scratch memory of a context and the
+// chains built in it
+STACK_DEFINE(hull2d_chain, flaggedindex_t)
+
+typedef enum hull2d_engine_e
+{
+    // Angular sort about the lowest point followed by Graham's scan
+    HULL2D_ENGINE_GRAHAM = 0,
+
+    // Lexicographic (x, y) sort followed by Andrew's monotone chain
+    HULL2D_ENGINE_MONOTONE,
+
+    // Chan's output sensitive algorithm, O(n log(h)) for h boundary points
+    HULL2D_ENGINE_CHAN,
+
+    // QuickHull, recursively partitions the boundary list in place
+    HULL2D_ENGINE_QUICKHULL
+} hull2d_engine_t;
+
+typedef enum hull2d_cull_e
+{
+    // Every point is passed to the construction engine
+    HULL2D_CULL_NONE = 0,
+
+    // Discard points strictly inside the quadrilateral of x/y extremes
+    HULL2D_CULL_QUAD,
+
+    // Discard points strictly inside the octagon of x/y and diagonal extremes
+    HULL2D_CULL_OCTAGON
+} hull2d_cull_t;
+
 typedef struct hull2d_s
 {
     // Points that make up the hull
-    Point2f        points[MAX_POINTS_PER_HULL];
+    Point2f*       points;
     uint32_t       pointCount;
 
     // Indices of points that make up the boundary of the hull
-    flaggedindex_t boundaryIdx[MAX_POINTS_PER_HULL];
+    flaggedindex_t* boundaryIdx;
     uint32_t       boundaryCount;
 
+    // Boundary vertices of a computed hull in order, starting at the lowest
+    // point, with the first vertex repeated after the last. Only valid while
+    // the hull isn't dirty.
+    float*         vertexX;
+    float*         vertexY;
+
+    // Bounding box and bounding circle of a computed hull, stored with the
+    // vertex arrays so hull2d_checkIntersect can reject far apart hulls
+    // without walking their edges. Only valid while the hull isn't dirty.
+    float          minX;
+    float          minY;
+    float          maxX;
+    float          maxY;
+    float          centerX;
+    float          centerY;
+    float          radius;
+
+    // Number of points the hull has room for, at most MAX_POINTS_PER_HULL
+    uint32_t       capacity;
+
+    // points and boundaryIdx were allocated by hull2d_init
+    bool_t         ownsStorage;
+
     // An index to the index which references the lowest point (indirection :P)
     // The index is a location in the boundaryIdx list
     uint32_t       lowestIdx;
 
     // flag indicating hull needs to be (re)computed
     bool_t         dirty;
+
+    // Algorithm used by hull2d_computeHull (survives hull2d_clear)
+    hull2d_engine_t engine;
+
+    // Interior point culling run before the engine (survives hull2d_clear)
+    hull2d_cull_t  cull;
+
+    // hull2d_addPoint updates a computed hull in place (survives hull2d_clear)
+    bool_t         incremental;
+
+    // Point indices of the extreme points in the directions -y, +x-y, +x,
+    // +x+y, +y, -x+y, -x, -x-y. Kept up to date as points are added and only
+    // valid if extremesValid is set, removing a point clears it.
+    uint32_t       extremeIdx[HULL2D_DIRECTIONS];
+    bool_t         extremesValid;
 } hull2d_t;
 
+// Scratch memory used while hulls are built. It is sized once for
+// MAX_POINTS_PER_HULL points and reused by every call, threads building hulls
+// at the same time each need their own.
+typedef struct hull2d_context_s
+{
+    // sort keys, radix sort buffers, chains and merge lists
+    hull2d_chain_t scratch;
+} hull2d_context_t;
+
+/**
+* @brief Initialize hull object and allocate room for its points
+* @param[in/out] hull Pointer to the hull object
+* @param[in] capacity Maximum number of points, at most MAX_POINTS_PER_HULL
+* @return Returns false if the memory could not be allocated
+*/
+bool_t hull2d_init(hull2d_t* hull, uint32_t capacity);
+
 /**
-* @brief Initialize hull object
+* @brief Initialize hull object on caller owned memory, hull2d_destroy leaves
+*        the memory alone
 * @param[in/out] hull Pointer to the hull object
+* @param[in] capacity Maximum number of points, at most MAX_POINTS_PER_HULL
+* @param[in] buffer   At least HULL2D_BUFFER_SIZE(capacity) bytes aligned for
+*                     a Point2f, must outlive the hull. The vertex arrays are
+*                     16 byte aligned if buffer is.
 */
-void hull2d_init(hull2d_t* hull);
+void hull2d_initBuffer(hull2d_t* hull, uint32_t capacity, void* buffer);
 
 /**
-* @brief Initialize the stack object needed for cull creation
-* @param[in/out] stack Pointer to the stack object
+* @brief Free the memory allocated by hull2d_init
+* @param[in/out] hull Pointer to the hull object
 */
-void hull2d_initStack(stack_t* stack);
+void hull2d_destroy(hull2d_t* hull);
+
+/**
+* @brief Allocate the scratch memory of a hull construction context
+* @param[in/out] context Pointer to an uninitialized context
+* @return Returns false if the memory could not be allocated
+*/
+bool_t hull2d_initContext(hull2d_context_t* context);
+
+/**
+* @brief Free the scratch memory of a hull construction context
+* @param[in/out] context Pointer to the context
+*/
+void hull2d_destroyContext(hull2d_context_t* context);
 
 /**
 * @brief Clear an already existing hull object
@@ -49,29 +168,128 @@ void hull2d_initStack(stack_t* stack);
 */
 void hull2d_clear(hull2d_t* hull);
 
+/**
+* @brief Select the algorithm used to compute the hull
+* @param[in/out] hull Pointer to the hull object
+* @param[in] engine The hull construction algorithm
+*/
+void hull2d_setEngine(hull2d_t* hull, hull2d_engine_t engine);
+
+/**
+* @brief Select the Akl-Toussaint interior point culling run before the hull
+*        is computed
+* @param[in/out] hull Pointer to the hull object
+* @param[in] cull The culling polygon to use
+*/
+void hull2d_setCulling(hull2d_t* hull, hull2d_cull_t cull);
+
+/**
+* @brief Select whether hull2d_addPoint updates a computed hull in place.
+*        Points inside the hull are rejected in O(log(h)). Points outside
+*        are spliced into the boundary so the hull never becomes dirty, that
+*        rewrites the boundary list and vertex arrays and costs O(h).
+*        hull2d_addPoints always marks the hull dirty.
+* @param[in/out] hull Pointer to the hull object
+* @param[in] incremental True to update the hull on every hull2d_addPoint
+*/
+void hull2d_setIncremental(hull2d_t* hull, bool_t incremental);
+
 /**
 * @brief Add a point to the point list of a hull object
 * @param[in/out] hull Pointer to the hull object
 * @param[in] point Pointer to the point that will be added
+* @return Returns false if the hull is full, the point is not added
 */
-void hull2d_addPoint(hull2d_t* hull, const Point2f* point);
+bool_t hull2d_addPoint(hull2d_t* hull, const Point2f* point);
 
 /**
 * @brief Add multiple points to the point list of a hull object
 * @param[in/out] hull Pointer to the hull object
 * @param[in] points Array of points to be added
 * @param[in] count Number of points in points array
+* @return Returns false if the points don't fit, none of them are added
+*/
+bool_t hull2d_addPoints(hull2d_t* hull, const Point2f* points,
+    uint32_t count);
+
+/**
+* @brief Remove a point from the point list of a hull object. The last point in
+*        the list takes over the index of the removed point. Removing a vertex
+*        of a computed hull rebuilds only the boundary between its neighbours
+*        so the hull stays computed.
+* @param[in/out] hull Pointer to the hull object
+* @param[in] pointIdx Index of the point to remove
+* @return Returns false if pointIdx is not in the point list
 */
-void hull2d_addPoints(hull2d_t* hull, const Point2f* points, uint32_t count);
+bool_t hull2d_removePoint(hull2d_t* hull, uint32_t pointIdx);
 
 /**
 * @brief Compute the hull using the points in the hull's point list
-* @param hull Pointer to the hull object
-* @param stack A stack of points used as scratch space
+* @param hull    Pointer to the hull object
+* @param context A context initialized by hull2d_initContext
 * @return Returns true if able to create a hull false otherwise, only fails if
 *         two or less points are in the hull or all points fall on same line.
 */
-bool_t hull2d_computeHull(hull2d_t* hull, stack_t* stack);
+bool_t hull2d_computeHull(hull2d_t* hull, hull2d_context_t* context);
+
+/**
+* @brief Compute the hull on a pool of workers. The points are split into one
+*        chunk per worker, the chunks are hulled at the same time and merged
+*        pairwise in parallel rounds. Small point sets fall back to
+*        hull2d_computeHull.
+* @param hull    Pointer to the hull object
+* @param context A context initialized by hull2d_initContext, its scratch
+*                memory is split between the workers
+* @param pool    The workers, no more than one chunk is given to each
+* @return Returns true if able to create a hull false otherwise
+*/
+bool_t hull2d_computeHullParallel(hull2d_t* hull, hull2d_context_t* context,
+    pool_t* pool);
+
+/**
+* @brief Compute many independent hulls on a pool of workers. The hulls are
+*        spread over the workers with work stealing so a few large hulls
+*        don't hold up the rest, hulls that are already computed are skipped.
+* @param[in/out] hulls    Array of hull objects, each keeps its own settings
+* @param[in] count        Number of hulls
+* @param[in/out] contexts One context initialized by hull2d_initContext for
+*                         every worker of the pool
+* @param[in/out] pool     The workers
+* @return Returns true if every hull was computed, hulls that failed stay
+*         dirty
+*/
+bool_t hull2d_computeHulls(hull2d_t* hulls, uint32_t count,
+    hull2d_context_t* contexts, pool_t* pool);
+
+/**
+* @brief Compute the convex hull of two computed hulls in O(h1 + h2) without
+*        revisiting their interior points
+* @param[out] out      Receives the merged hull, its point list holds the
+*                      boundary points of ha followed by those of hb. Keeps
+*                      its engine settings, must not be ha or hb.
+* @param[in] ha        The first computed hull
+* @param[in] hb        The second computed hull
+* @param[in/out] context A context initialized by hull2d_initContext
+* @return Returns true if the merged hull has an interior, false if it doesn't
+*         or the boundaries don't fit in out
+*/
+bool_t hull2d_merge(hull2d_t* out, const hull2d_t* ha, const hull2d_t* hb,
+    hull2d_context_t* context);
+
+/**
+* @brief Compute the hull of a group of blobs. Every blob is hulled on its own
+*        and neighbouring blob hulls are merged pairwise until one is left, so
+*        no step ever sorts more than one blob.
+* @param[in/out] hull  Pointer to the hull object, cleared first and keeps its
+*                      engine settings
+* @param[in] corners   CORNERS_PER_BLOB points for every blob
+* @param[in] blobCount Number of blobs, at most MAX_BLOBS_PER_GROUP
+* @param[in/out] context A context initialized by hull2d_initContext
+* @return Returns true if the group hull has an interior, false if it doesn't
+*         or the corners don't fit in the hull
+*/
+bool_t hull2d_computeGroupHull(hull2d_t* hull, const Point2f* corners,
+    uint32_t blobCount, hull2d_context_t* context);
 
 /**
 * @brief Check if two convex hulls intersect
@@ -81,5 +299,39 @@ bool_t hull2d_computeHull(hull2d_t* hull, stack_t* stack);
 */
 bool_t hull2d_checkIntersect(const hull2d_t* h1, const hull2d_t* h2);
 
+/**
+* @brief Check if two convex hulls intersect with GJK and find how far apart
+*        they are. Converges in a few steps of O(log(n)) each, faster than
+*        hull2d_checkIntersect for large hulls that are usually apart.
+* @param[in] h1        The first hull
+* @param[in] h2        The second hull
+* @param[out] distance Receives the distance between the hulls, 0 if they
+*                      intersect, may be NULL
+* @return True if h1 intersects h2, false otherwise
+*/
+bool_t hull2d_checkIntersectGjk(const hull2d_t* h1, const hull2d_t* h2,
+    float* distance);
+
+/**
+* @brief Check if a point is inside a computed convex hull
+* @param[in] hull Pointer to the hull
+* @param[in] p    Pointer to the point
+* @return Returns TRUE if the point is inside the hull, FALSE otherwise
+*/
+bool_t hull2d_pointInHull(const hull2d_t* hull, const Point2f* p);
+
+/**
+* @brief Find where a segment first enters a computed convex hull
+* @param[in] hull      Pointer to the hull, hulls of less than three boundary
+*                      points are never hit
+* @param[in] from      Start of the segment
+* @param[in] to        End of the segment
+* @param[out] fraction Receives the position of the first hit along the
+*                      segment, 0 at from and 1 at to, 0 if from is inside
+* @return Returns TRUE if the segment hits the hull, FALSE otherwise
+*/
+bool_t hull2d_raycast(const hull2d_t* hull, const Point2f* from,
+    const Point2f* to, float* fraction);
+
 #endif // CONVEX2D_H
 
@@ -0,0 +1,71 @@
+#ifndef POOL_JG_H
+#define POOL_JG_H
+
+// A small fixed size worker pool, threads are created once and reused
+
+#include "defines.h"
+
+// Upper bound on the number of workers in a pool
+#define POOL_MAX_WORKERS (64U)
+
+/**
+* @brief Work function run by the pool
+* @param[in/out] context Pointer passed to pool_run
+* @param[in] task        Index of the task to run, in [0, taskCount)
+* @param[in] worker      Index of the worker running the task, in
+*                        [0, workerCount), the calling thread is worker 0
+*/
+typedef void (*pool_fn_t)(void* context, uint32_t task, uint32_t worker);
+
+typedef struct pool_s {
+    // number of workers including the thread calling pool_run
+    uint32_t workerCount;
+
+    // platform specific threads and synchronization
+    struct pool_impl_s* impl;
+} pool_t;
+
+/**
+* @brief Get the number of processors available to this process
+* @return Returns the number of processors, at least 1
+*/
+uint32_t pool_coreCount(void);
+
+/**
+* @brief Initialize a pool and start its threads
+* @param[in/out] pool   Pointer to an uninitialized pool object
+* @param[in] workerCount Number of workers including the calling thread, 0 to
+*                        use one worker per processor
+* @return Returns false if the threads could not be started
+*/
+bool_t pool_init(pool_t* pool, uint32_t workerCount);
+
+/**
+* @brief Stop the threads of a pool and free its resources
+* @param[in/out] pool Pointer to the pool object
+*/
+void pool_destroy(pool_t* pool);
+
+/**
+* @brief Run taskCount tasks on the pool and wait for all of them to finish.
+*        The calling thread works on tasks too.
+* @param[in/out] pool    Pointer to the pool object
+* @param[in] fn          Function called once for every task
+* @param[in/out] context Pointer passed to every call of fn
+* @param[in] taskCount   Number of tasks
+*/
+void pool_run(pool_t* pool, pool_fn_t fn, void* context, uint32_t taskCount);
+
+/**
+* @brief Same as pool_run for many small tasks of uneven cost. Every worker
+*        starts on its own contiguous range of tasks and steals the back half
+*        of another worker's range when its own runs out.
+* @param[in/out] pool    Pointer to the pool object
+* @param[in] fn          Function called once for every task
+* @param[in/out] context Pointer passed to every call of fn
+* @param[in] taskCount   Number of tasks
+*/
+void pool_runStealing(pool_t* pool, pool_fn_t fn, void* context,
+    uint32_t taskCount);
+
+#endif
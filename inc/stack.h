@@ -30,14 +30,15 @@ void stack_clear(stack_t* stack);
 * @brief Push onto the stack
 * @param[in/out] stack Pointer to the stack
 * @param[in] item      Pointer to the item to put on the stack
-* @return Returns false if the stack is full after inserting the item
+* @return Returns false if the stack is full, the item is not added
 */
 bool_t stack_push(stack_t* stack, const void* item);
 
 /**
 * @brief Pop the top item from the stack
 * @param[in/out] stack Pointer to the stack
-* @return Returns false if the stack is empty after poping
+* @return Returns false if the stack is empty after poping, popping an empty
+*         stack leaves it empty
 */
 bool_t stack_pop(stack_t* stack);
 
@@ -57,4 +58,118 @@ bool_t stack_peek(const stack_t* stack, int32_t idx, void* item);
 */
 int32_t stack_count(const stack_t* stack);
 
+// Typed stacks
+//
+// STACK_DEFINE(name, type) generates a stack of type items called name_t and
+// static functions name_init, name_view, name_destroy, name_clear, name_push,
+// name_pop, name_peek and name_count that work like their stack_t
+// counterparts. Items are copied by assignment and the functions are inline,
+// so a push or peek compiles to a plain store or load. A stack from name_init
+// doubles its memory when a push finds it full. A stack from name_view lives
+// in caller memory, so a push to a full one fails and leaves the stack as it
+// was.
+
+#if defined(_MSC_VER) && !defined(__cplusplus)
+#define STACK_INLINE static __inline
+#else
+#define STACK_INLINE static inline
+#endif
+
+#define STACK_DEFINE(NAME, TYPE)                                             \
+typedef struct NAME##_s {                                                   \
+    int32_t top;                                                            \
+    int32_t maxItems;                                                       \
+    bool_t  ownsData;                                                       \
+    TYPE*   data;                                                           \
+} NAME##_t;                                                                 \
+                                                                            \
+/* allocate room for maxItems items, returns false if out of memory */     \
+STACK_INLINE bool_t NAME##_init(NAME##_t* stack, int32_t maxItems)          \
+{                                                                           \
+    stack->top = -1;                                                        \
+    stack->maxItems = maxItems;                                             \
+    stack->ownsData = TRUE;                                                 \
+    stack->data = (TYPE*)malloc(sizeof(TYPE) * (size_t)maxItems);           \
+    return (stack->data != NULL);                                           \
+}                                                                           \
+                                                                            \
+/* use maxItems items of caller memory, the stack never grows */           \
+STACK_INLINE void NAME##_view(NAME##_t* stack, TYPE* data, int32_t maxItems)\
+{                                                                           \
+    stack->top = -1;                                                        \
+    stack->maxItems = maxItems;                                             \
+    stack->ownsData = FALSE;                                                \
+    stack->data = data;                                                     \
+}                                                                           \
+                                                                            \
+STACK_INLINE void NAME##_destroy(NAME##_t* stack)                           \
+{                                                                           \
+    if (stack->ownsData)                                                    \
+    {                                                                       \
+        free(stack->data);                                                  \
+    }                                                                       \
+    stack->data = NULL;                                                     \
+    stack->maxItems = 0;                                                    \
+    stack->top = -1;                                                        \
+}                                                                           \
+                                                                            \
+STACK_INLINE void NAME##_clear(NAME##_t* stack)                             \
+{                                                                           \
+    stack->top = -1;                                                        \
+}                                                                           \
+                                                                            \
+/* double the memory of a full stack, kept out of the push fast path */    \
+STACK_INLINE bool_t NAME##_grow(NAME##_t* stack)                            \
+{                                                                           \
+    TYPE* data;                                                             \
+    int32_t maxItems = (stack->maxItems > 0) ? 2 * stack->maxItems : 16;    \
+                                                                            \
+    if (!stack->ownsData)                                                   \
+    {                                                                       \
+        return FALSE;                                                       \
+    }                                                                       \
+    data = (TYPE*)realloc(stack->data, sizeof(TYPE) * (size_t)maxItems);    \
+    if (data == NULL)                                                       \
+    {                                                                       \
+        return FALSE;                                                       \
+    }                                                                       \
+    stack->data = data;                                                     \
+    stack->maxItems = maxItems;                                             \
+    return TRUE;                                                            \
+}                                                                           \
+                                                                            \
+/* returns false if the stack is full and can't grow, nothing is added */  \
+STACK_INLINE bool_t NAME##_push(NAME##_t* stack, TYPE item)                 \
+{                                                                           \
+    if (stack->top + 1 >= stack->maxItems && !NAME##_grow(stack))           \
+    {                                                                       \
+        return FALSE;                                                       \
+    }                                                                       \
+    stack->data[++stack->top] = item;                                       \
+    return TRUE;                                                            \
+}                                                                           \
+                                                                            \
+/* returns false if the stack is empty after popping, like stack_pop */    \
+STACK_INLINE bool_t NAME##_pop(NAME##_t* stack)                             \
+{                                                                           \
+    if (stack->top < 0)                                                     \
+    {                                                                       \
+        return FALSE;                                                       \
+    }                                                                       \
+    stack->top--;                                                           \
+    return !(stack->top < 0);                                               \
+}                                                                           \
+                                                                            \
+/* the item idx levels from the top, idx must be less than the count */    \
+STACK_INLINE TYPE NAME##_peek(const NAME##_t* stack, int32_t idx)           \
+{                                                                           \
+    LOGASSERT(idx >= 0 && idx <= stack->top);                               \
+    return stack->data[stack->top - idx];                                   \
+}                                                                           \
+                                                                            \
+STACK_INLINE int32_t NAME##_count(const NAME##_t* stack)                    \
+{                                                                           \
+    return stack->top + 1;                                                  \
+}
+
 #endif
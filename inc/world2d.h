@@ -0,0 +1,256 @@
+#ifndef WORLD2D_H
+#define WORLD2D_H
+
+// A collision world over many hulls. The broad phase finds the pairs of hulls
+// whose bounding boxes overlap and the narrow phase only runs on those.
+
+#include "hull2d.h"
+
+// Returned by world2d_add when the world is full, also marks missing nodes
+#define WORLD2D_INVALID_HANDLE (0xFFFFFFFFU)
+
+typedef enum world2d_broadphase_e
+{
+    // Boxes sorted along x and swept, best when hulls move coherently
+    WORLD2D_BROADPHASE_SWEEP = 0,
+
+    // Boxes hashed into a uniform grid, O(1) expected per hull and query
+    // when hulls are of similar size and spread evenly. Every update rebuilds
+    // the whole grid, O(n + c) for n hulls covering c cells, however few
+    // hulls moved.
+    WORLD2D_BROADPHASE_GRID,
+
+    // Dynamic tree of enlarged boxes, O(log(n)) per query whatever the hull
+    // sizes, and the only broad phase that speeds up rays
+    WORLD2D_BROADPHASE_TREE
+} world2d_broadphase_t;
+
+typedef enum world2d_narrowphase_e
+{
+    // hull2d_checkIntersect, walks the edges of both hulls, best for hulls
+    // with few vertices
+    WORLD2D_NARROWPHASE_EDGES = 0,
+
+    // hull2d_checkIntersectGjk, O(log(n)) per step, best for hulls with many
+    // vertices that come close without touching
+    WORLD2D_NARROWPHASE_GJK
+} world2d_narrowphase_t;
+
+typedef struct world2d_box_s
+{
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+} world2d_box_t;
+
+// Two hulls found by the broad or narrow phase, a < b
+typedef struct world2d_pair_s
+{
+    uint32_t a;
+    uint32_t b;
+} world2d_pair_t;
+
+// A hull covering one grid cell
+typedef struct world2d_cell_s
+{
+    uint32_t handle;
+    int32_t  x;
+    int32_t  y;
+} world2d_cell_t;
+
+// A node of the dynamic tree. Leaves hold one hull and have no children,
+// inner nodes have two and their box encloses the boxes of both.
+typedef struct world2d_node_s
+{
+    world2d_box_t box;
+
+    // Parent node, or the next node of the free list for unused nodes
+    uint32_t      parent;
+    uint32_t      child1;
+    uint32_t      child2;
+
+    // Handle of the hull in a leaf
+    uint32_t      handle;
+
+    // 0 for leaves, -1 for unused nodes
+    int32_t       height;
+} world2d_node_t;
+
+typedef struct world2d_s
+{
+    // Hulls in the world, a handle is an index into this list
+    const hull2d_t** hulls;
+    uint32_t         count;
+    uint32_t         capacity;
+
+    // Bounding box of every hull as of the last world2d_update, empty for
+    // hulls that are dirty
+    world2d_box_t*   boxes;
+
+    // Handles sorted by the left edge of their box. Hulls move little between
+    // frames so the order stays nearly sorted and insertion sort restores it
+    // in close to linear time.
+    uint32_t*        order;
+
+    // Broad phase used by world2d_update and the queries
+    world2d_broadphase_t broadphase;
+
+    // Intersection test run by world2d_collide on the broad phase pairs
+    world2d_narrowphase_t narrowphase;
+
+    // Grid cell size requested with world2d_setCellSize, 0 picks the average
+    // box size on every update, and the inverse of the size last used
+    float            cellSize;
+    float            invCell;
+
+    // Cells covered by every box, grouped by hash bucket. Bucket i holds
+    // cells[buckets[i]] up to cells[buckets[i + 1]].
+    world2d_cell_t*  cells;
+    uint32_t         cellCount;
+    uint32_t         cellCapacity;
+    uint32_t*        buckets;
+    uint32_t         bucketCount;
+
+    // Dynamic tree with room for 2 * capacity nodes. A leaf stores the box of
+    // its hull enlarged by a margin so it is only reinserted once the hull
+    // moves out of it. leaves[handle] is the leaf of a hull.
+    world2d_node_t*  nodes;
+    uint32_t         root;
+    uint32_t         freeNode;
+    uint32_t*        leaves;
+} world2d_t;
+
+/**
+* @brief Initialize a world and allocate room for its hulls
+* @param[in/out] world Pointer to an uninitialized world
+* @param[in] capacity  Maximum number of hulls
+* @return Returns false if the memory could not be allocated
+*/
+bool_t world2d_init(world2d_t* world, uint32_t capacity);
+
+/**
+* @brief Free the memory of a world, the hulls are left alone
+* @param[in/out] world Pointer to the world
+*/
+void world2d_destroy(world2d_t* world);
+
+/**
+* @brief Add a hull to the world. The world keeps a pointer to the hull, which
+*        must stay valid until it is removed.
+* @param[in/out] world Pointer to the world
+* @param[in] hull      The hull to add
+* @return Returns the handle of the hull, WORLD2D_INVALID_HANDLE if the world
+*         is full
+*/
+uint32_t world2d_add(world2d_t* world, const hull2d_t* hull);
+
+/**
+* @brief Remove a hull from the world. The hull added last takes over the
+*        handle of the removed hull.
+* @param[in/out] world Pointer to the world
+* @param[in] handle    Handle of the hull to remove
+* @return Returns false if handle is not in the world
+*/
+bool_t world2d_remove(world2d_t* world, uint32_t handle);
+
+/**
+* @brief Select the broad phase, takes effect on the next world2d_update
+* @param[in/out] world  Pointer to the world
+* @param[in] broadphase The broad phase algorithm
+*/
+void world2d_setBroadphase(world2d_t* world, world2d_broadphase_t broadphase);
+
+/**
+* @brief Select the intersection test run on the pairs found by the broad
+*        phase, takes effect immediately
+* @param[in/out] world   Pointer to the world
+* @param[in] narrowphase The intersection test
+*/
+void world2d_setNarrowphase(world2d_t* world,
+    world2d_narrowphase_t narrowphase);
+
+/**
+* @brief Set the cell size of the grid broad phase. Cells about the size of a
+*        typical hull work best, a hull much larger than a cell is stored in
+*        every cell it covers. Cells are enlarged when the boxes would cover
+*        more than 64 cells per hull on average.
+* @param[in/out] world Pointer to the world
+* @param[in] cellSize  Width and height of a cell, 0 to use the average box
+*                      size of the hulls in the world
+*/
+void world2d_setCellSize(world2d_t* world, float cellSize);
+
+/**
+* @brief Refresh the bounding boxes after hulls were added, moved or removed
+*        and rebuild the broad phase. Dirty hulls get an empty box and never
+*        collide. Every box is recomputed whatever moved, the grid is then
+*        rebuilt from scratch with a counting sort over all hulls and cells,
+*        the sweep re-sorted and the tree only reinserts hulls that left their
+*        enlarged box.
+* @param[in/out] world Pointer to the world
+* @return Returns false if the grid could not grow, the queries then report
+*         nothing until an update succeeds
+*/
+bool_t world2d_update(world2d_t* world);
+
+/**
+* @brief Broad phase, find every pair of hulls whose bounding boxes overlap
+*        as of the last world2d_update
+* @param[in] world    Pointer to the world
+* @param[out] pairs   Receives up to maxPairs pairs
+* @param[in] maxPairs Size of the pairs array
+* @return Returns the number of pairs found, which may be more than maxPairs
+*/
+uint32_t world2d_findPairs(const world2d_t* world, world2d_pair_t* pairs,
+    uint32_t maxPairs);
+
+/**
+* @brief Broad and narrow phase, find every pair of intersecting hulls as of
+*        the last world2d_update
+* @param[in] world    Pointer to the world
+* @param[out] pairs   Receives up to maxPairs pairs
+* @param[in] maxPairs Size of the pairs array
+* @return Returns the number of pairs found, which may be more than maxPairs
+*/
+uint32_t world2d_collide(const world2d_t* world, world2d_pair_t* pairs,
+    uint32_t maxPairs);
+
+/**
+* @brief Find every hull whose bounding box overlaps a region as of the last
+*        world2d_update
+* @param[in] world      Pointer to the world
+* @param[in] region     The region to search
+* @param[out] handles   Receives up to maxHandles handles
+* @param[in] maxHandles Size of the handles array
+* @return Returns the number of hulls found, which may be more than maxHandles
+*/
+uint32_t world2d_query(const world2d_t* world, const world2d_box_t* region,
+    uint32_t* handles, uint32_t maxHandles);
+
+/**
+* @brief Find every hull containing a point as of the last world2d_update
+* @param[in] world      Pointer to the world
+* @param[in] p          The point
+* @param[out] handles   Receives up to maxHandles handles
+* @param[in] maxHandles Size of the handles array
+* @return Returns the number of hulls found, which may be more than maxHandles
+*/
+uint32_t world2d_queryPoint(const world2d_t* world, const Point2f* p,
+    uint32_t* handles, uint32_t maxHandles);
+
+/**
+* @brief Find the first hull hit by a segment as of the last world2d_update.
+*        Only the tree broad phase avoids testing every box.
+* @param[in] world     Pointer to the world
+* @param[in] from      Start of the segment
+* @param[in] to        End of the segment
+* @param[out] fraction Receives the position of the hit along the segment, 0
+*                      at from and 1 at to
+* @return Returns the handle of the hull hit, WORLD2D_INVALID_HANDLE if the
+*         segment hits nothing
+*/
+uint32_t world2d_raycast(const world2d_t* world, const Point2f* from,
+    const Point2f* to, float* fraction);
+
+#endif // WORLD2D_H
@@ -8,9 +8,25 @@
 * the intersection exists or not. I choose this approach because its faster
 * than a direct application of the separating axis theorem.
 *
+* Andrew's monotone chain is available as an alternative construction engine.
+* It sorts by (x, y) so no orientation test is needed inside the sort.
+* Chan's algorithm is available for large point sets with few boundary points.
+* QuickHull partitions the boundary list in place and needs no scratch space.
+* hull2d_computeHullParallel splits the points into chunks that are hulled on
+* a worker pool and merged pairwise in linear time.
+*
+* Scans that test many points against one line (culling, QuickHull partitions)
+* evaluate the orientation 8 points at a time with AVX2 when the processor
+* supports it, hull2d_pointInHull tests one point against 4 edges at a time.
+* The signs are identical to the scalar test.
+*
+* Optionally the Akl-Toussaint heuristic discards every point strictly inside
+* the polygon of extreme points before any engine runs, which removes most of
+* the points of a dense cloud in linear time.
+*
 * Complexity
-* For points list of size s
-*   Hull construction: O(s log(s))
+* For points list of size s with h points on the boundary
+*   Hull construction: O(s log(s)), Chan's algorithm O(s log(h))
 * For two convex hulls with n and m points on their boundaries respectively
 *   Intersection test: O(n + m)
 *
@@ -18,11 +34,226 @@
 * Date: 05/09/2016
 */
 
+typedef struct hull2d_run_s
+{
+    const flaggedindex_t* ring;  // first index of the ring
+    uint32_t size;  // number of points in the ring
+    uint32_t pos;   // current location in the ring
+    uint32_t left;  // number of points left in the run
+    uint32_t step;  // 1 to walk CCW, size - 1 to walk CW
+} hull2d_run_t;
+
+static void hull2d_insertPoint(hull2d_t* hull, const flaggedindex_t* qidx);
+static void hull2d_findLowest(hull2d_t* hull);
+static bool_t hull2d_removeVertex(hull2d_t* hull, uint32_t k);
+static bool_t hull2d_runEngine(hull2d_t* hull, hull2d_chain_t* scratch);
+static void hull2d_swap(flaggedindex_t* a, flaggedindex_t* b);
+static void hull2d_ingest(hull2d_t* hull, uint32_t count);
+static void hull2d_updateExtremes(hull2d_t* hull, uint32_t pointIdx);
+static void hull2d_findExtremes(hull2d_t* hull);
+static bool_t hull2d_lower(const Point2f* p, const Point2f* p0);
+static void hull2d_storeVertices(hull2d_t* hull);
+static uint32_t hull2d_dropStraight(const hull2d_t* hull,
+    flaggedindex_t* ring, uint32_t n);
+
+typedef struct hull2d_sortkey_s
+{
+    double angle;  // pseudo-angle about the lowest point
+    double dist;   // L1 distance from the lowest point, breaks ties
+} hull2d_sortkey_t;
+
+typedef struct hull2d_radixpair_s
+{
+    uint64_t key;       // double key mapped to an order preserving integer
+    uint32_t pointIdx;
+} hull2d_radixpair_t;
+
+// Lists at least this long are sorted with the radix sort
+#define HULL2D_RADIX_THRESHOLD (512U)
+
+// Rounding error of a pseudo-angle key is below 2 DBL_EPSILON, keys closer
+// than this may be in the wrong order and are ordered by orientation instead
+#define HULL2D_KEY_TOLERANCE   (8.0 * DBL_EPSILON)
+
+// Stack items taken by the sort keys of Graham's algorithm, a key is wider
+// than an index
+#define HULL2D_KEY_ITEMS       ((uint32_t)(MAX_POINTS_PER_HULL * \
+    sizeof(hull2d_sortkey_t) / sizeof(flaggedindex_t)))
+
+// Stack items needed for sort keys and both radix buffers, this also covers
+// the monotone chain which may briefly hold one index more than the points
+#define HULL2D_SCRATCH_ITEMS   (3U * HULL2D_KEY_ITEMS)
+
+// Tolerance for hulls of subsets that are combined later, a point that looks
+// collinear within a small subset can still be on the final boundary
+#define HULL2D_EXACT (0.0)
+
+// Orientation signs are evaluated this many points at a time
+#define HULL2D_SIGN_BLOCK (64U)
+
+// AVX2 orientation kernel, picked at run time when the processor has it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HULL2D_AVX2
+#define HULL2D_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#define HULL2D_AVX2
+#define HULL2D_TARGET_AVX2
+#endif
+
+// Directions of the cached extreme points, in CCW order starting at -y:
+// -y, +x-y, +x, +x+y, +y, -x+y, -x, -x-y
+static const float hull2d_dirX[HULL2D_DIRECTIONS] =
+    { 0.0f,  1.0f, 1.0f, 1.0f, 0.0f, -1.0f, -1.0f, -1.0f };
+static const float hull2d_dirY[HULL2D_DIRECTIONS] =
+    { -1.0f, -1.0f, 0.0f, 1.0f, 1.0f,  1.0f,  0.0f, -1.0f };
+
+// Fewest points given to each worker by hull2d_computeHullParallel, smaller
+// chunks cost more to hand out than to hull
+#define HULL2D_PARALLEL_MIN_CHUNK (256U)
+
+typedef struct hull2d_parallel_s
+{
+    hull2d_t* hull;
+    const hull2d_chain_t* scratch;  // scratch shared by all workers
+    uint32_t chunkCount;
+    uint32_t start[POOL_MAX_WORKERS + 1];  // first boundary index of a chunk
+    uint32_t size[POOL_MAX_WORKERS];       // boundary points of a chunk
+    uint32_t span;           // distance between the chunks of a merge
+    double   tolerance;      // orientation tolerance of the current round
+} hull2d_parallel_t;
+
+typedef struct hull2d_batch_s
+{
+    hull2d_t* hulls;
+    hull2d_context_t* contexts;            // one for every worker
+    uint32_t failed[POOL_MAX_WORKERS];     // hulls a worker couldn't compute
+} hull2d_batch_t;
+
+// First group size tried by Chan's algorithm, also bounds the number of groups
+#define HULL2D_CHAN_MIN_GROUP  (16U)
+#define HULL2D_CHAN_MAX_GROUPS (MAX_POINTS_PER_HULL / HULL2D_CHAN_MIN_GROUP + 1)
+
+// Boundaries of at most this many vertices are scanned for a support point,
+// longer ones are binary searched
+#define HULL2D_SUPPORT_SCAN (8U)
+
+// GJK stops once it repeats a vertex, this only bounds it against rounding
+#define HULL2D_GJK_MAX_ITERATIONS (64U)
+
+// Vertices of the Minkowski difference A - B GJK closes in on the origin with,
+// each is the difference of boundary vertex idxA of A and idxB of B
+typedef struct hull2d_simplex_s
+{
+    Point2f  w[3];
+    uint32_t idxA[3];
+    uint32_t idxB[3];
+    uint32_t count;
+} hull2d_simplex_t;
+
+/**
+* @brief Initialize hull object and allocate room for its points
+* @param[in/out] hull Pointer to the hull object
+* @param[in] capacity Maximum number of points, at most MAX_POINTS_PER_HULL
+* @return Returns false if the memory could not be allocated
+*/
+bool_t hull2d_init(hull2d_t* hull, uint32_t capacity)
+{
+    void* buffer;
+
+    // always allocate something so the first point slot exists
+    buffer = malloc(HULL2D_BUFFER_SIZE((capacity > 0) ? capacity : 1));
+    hull2d_initBuffer(hull, capacity, buffer);
+    hull->ownsStorage = (buffer != NULL);
+
+    return (buffer != NULL);
+}
+
+/**
+* @brief Initialize hull object on caller owned memory
+* @param[in/out] hull Pointer to the hull object
+* @param[in] capacity Maximum number of points, at most MAX_POINTS_PER_HULL
+* @param[in] buffer   At least HULL2D_BUFFER_SIZE(capacity) bytes aligned for
+*                     a Point2f, must outlive the hull
+*/
+void hull2d_initBuffer(hull2d_t* hull, uint32_t capacity, void* buffer)
+{
+    // the scratch memory of a context is sized for MAX_POINTS_PER_HULL
+    LOGASSERT(capacity <= MAX_POINTS_PER_HULL);
+
+    // vertex arrays first, their stride keeps everything after them aligned
+    hull->vertexX = (float*)buffer;
+    hull->vertexY = &hull->vertexX[HULL2D_VERTEX_STRIDE(capacity)];
+    hull->points = (Point2f*)&hull->vertexY[HULL2D_VERTEX_STRIDE(capacity)];
+    hull->boundaryIdx = (flaggedindex_t*)&hull->points[capacity];
+    hull->capacity = (buffer != NULL) ? capacity : 0;
+    hull->ownsStorage = FALSE;
+
+    hull->engine = HULL2D_ENGINE_GRAHAM;
+    hull->cull = HULL2D_CULL_NONE;
+    hull->incremental = FALSE;
+    hull2d_clear(hull);
+}
+
+/**
+* @brief Free the memory allocated by hull2d_init
+* @param[in/out] hull Pointer to the hull object
+*/
+void hull2d_destroy(hull2d_t* hull)
+{
+    if (hull->ownsStorage)
+    {
+        // the allocation starts at the vertex arrays
+        free(hull->vertexX);
+    }
+    hull->points = NULL;
+    hull->boundaryIdx = NULL;
+    hull->vertexX = NULL;
+    hull->vertexY = NULL;
+    hull->capacity = 0;
+    hull->ownsStorage = FALSE;
+    hull->pointCount = 0;
+    hull->boundaryCount = 0;
+}
+
+/**
+* @brief Select the Akl-Toussaint interior point culling run before the hull
+*        is computed
+* @param[in/out] hull Pointer to the hull object
+* @param[in] cull The culling polygon to use
+*/
+void hull2d_setCulling(hull2d_t* hull, hull2d_cull_t cull)
+{
+    // culling never changes the result so the hull stays clean
+    hull->cull = cull;
+}
+
+/**
+* @brief Allocate the scratch memory of a hull construction context
+* @param[in/out] context Pointer to an uninitialized context
+* @return Returns false if the memory could not be allocated
+*/
+bool_t hull2d_initContext(hull2d_context_t* context)
+{
+    return hull2d_chain_init(&context->scratch, HULL2D_SCRATCH_ITEMS);
+}
+
+/**
+* @brief Free the scratch memory of a hull construction context
+* @param[in/out] context Pointer to the context
+*/
+void hull2d_destroyContext(hull2d_context_t* context)
+{
+    hull2d_chain_destroy(&context->scratch);
+}
+
 /**
-* @brief Initialize hull object
+* @brief Clear an already existing hull object
 * @param[in/out] hull Pointer to the hull object
 */
-void hull2d_init(hull2d_t* hull)
+void hull2d_clear(hull2d_t* hull)
 {
     hull->dirty = TRUE;
     hull->pointCount = 0;
@@ -30,47 +261,82 @@ void hull2d_init(hull2d_t* hull)
     hull->lowestIdx = 0;
 
     // necessary for initial comparison for lowest point
-    hull->boundaryIdx[0].pointIdx = 0;
-    hull->boundaryIdx[0].remove = FALSE;
+    if (hull->capacity > 0)
+    {
+        hull->boundaryIdx[0].pointIdx = 0;
+        hull->boundaryIdx[0].remove = FALSE;
+    }
+
+    // the first point added starts out as the extreme in every direction
+    memset(hull->extremeIdx, 0, sizeof(hull->extremeIdx));
+    hull->extremesValid = TRUE;
 }
 
 /**
-* @brief Initialize the stack object needed during cull creation
-* @param[in/out] stack Pointer to the stack object
+* @brief Select the algorithm used to compute the hull
+* @param[in/out] hull Pointer to the hull object
+* @param[in] engine The hull construction algorithm
 */
-void hull2d_initStack(stack_t* stack)
+void hull2d_setEngine(hull2d_t* hull, hull2d_engine_t engine)
 {
-    LOGASSERT(stack_init(stack, MAX_POINTS_PER_HULL, sizeof(flaggedindex_t)));
+    if (hull->engine != engine)
+    {
+        hull->engine = engine;
+        hull->dirty = TRUE;
+    }
 }
 
 /**
-* @brief Clear an already existing hull object
+* @brief Select whether hull2d_addPoint updates a computed hull in place
 * @param[in/out] hull Pointer to the hull object
+* @param[in] incremental True to update the hull on every hull2d_addPoint
 */
-void hull2d_clear(hull2d_t* hull)
+void hull2d_setIncremental(hull2d_t* hull, bool_t incremental)
 {
-    hull2d_init(hull);
+    hull->incremental = incremental;
 }
 
 /**
 * @brief Add a point to the point list of a hull object
 * @param[in/out] hull Pointer to the hull object
 * @param[in] point Pointer to the point that will be added
+* @return Returns false if the hull is full, the point is not added
 */
-void hull2d_addPoint(hull2d_t* hull, const Point2f* point)
+bool_t hull2d_addPoint(hull2d_t* hull, const Point2f* point)
 {
     Point2f *p0;
+    flaggedindex_t idx;
+
+    if (hull->pointCount >= hull->capacity)
+    {
+        return FALSE;
+    }
+
     memcpy(&hull->points[hull->pointCount], point, sizeof(Point2f));
-    hull->dirty = TRUE;
 
     // add a reference to the new point in the boundaryIdx list
-    hull->boundaryIdx[hull->boundaryCount].pointIdx = hull->pointCount;
-    hull->boundaryIdx[hull->boundaryCount].remove = FALSE;
+    idx.pointIdx = hull->pointCount;
+    idx.remove = FALSE;
+
+    if (hull->extremesValid)
+    {
+        hull2d_updateExtremes(hull, idx.pointIdx);
+    }
+
+    // splice the point into an already computed hull
+    if (hull->incremental && !hull->dirty)
+    {
+        hull2d_insertPoint(hull, &idx);
+        hull->pointCount += 1;
+        return TRUE;
+    }
+
+    hull->dirty = TRUE;
+    hull->boundaryIdx[hull->boundaryCount] = idx;
 
     // Check if this is the lowest point (if same choose the right-most)
     p0 = &hull->points[hull->boundaryIdx[hull->lowestIdx].pointIdx];
-    if ((point->y < p0->y) || 
-        (fabs(point->y - p0->y) <= FLT_EPSILON && point->x > p0->x))
+    if (hull2d_lower(point, p0))
     {
         hull->lowestIdx = hull->boundaryCount;
     }
@@ -78,6 +344,8 @@ void hull2d_addPoint(hull2d_t* hull, const Point2f* point)
     // update the point counts
     hull->pointCount += 1;
     hull->boundaryCount += 1;
+
+    return TRUE;
 }
 
 /**
@@ -85,36 +353,125 @@ void hull2d_addPoint(hull2d_t* hull, const Point2f* point)
 * @param[in/out] hull Pointer to the hull object
 * @param[in] points Array of points to be added
 * @param[in] count Number of points in points array
+* @return Returns false if the points don't fit, none of them are added
 */
-void hull2d_addPoints(hull2d_t* hull, const Point2f* points, uint32_t count)
+bool_t hull2d_addPoints(hull2d_t* hull, const Point2f* points,
+    uint32_t count)
 {
-    uint32_t i;
-    Point2f *p0, *p;
+    if (count > hull->capacity - hull->pointCount)
+    {
+        return FALSE;
+    }
 
     memcpy(&hull->points[hull->pointCount], points, sizeof(Point2f)*count);
     hull->dirty = TRUE;
 
-    p0 = &hull->points[hull->boundaryIdx[hull->lowestIdx].pointIdx];
-    for (i = 0; i < count; ++i)
+    // reference the new points, keep track of lowest and extreme points
+    hull2d_ingest(hull, count);
+
+    // Update point count
+    hull->pointCount += count;
+    hull->boundaryCount += count;
+
+    return TRUE;
+}
+
+/**
+* @brief Remove a point from the point list of a hull object, the last point
+*        in the list takes over the index of the removed point
+* @param[in/out] hull Pointer to the hull object
+* @param[in] pointIdx Index of the point to remove
+* @return Returns false if pointIdx is not in the point list
+*/
+bool_t hull2d_removePoint(hull2d_t* hull, uint32_t pointIdx)
+{
+    uint32_t i, k, last;
+    bool_t rebuild;
+
+    if (pointIdx >= hull->pointCount)
     {
-        // add a reference to the new point in the boundaryIdx list
-        hull->boundaryIdx[hull->boundaryCount + i].pointIdx =
-            hull->pointCount + i;
-        hull->boundaryIdx[hull->boundaryCount + i].remove = FALSE;
+        return FALSE;
+    }
 
-        // Keep track of lowest point (if same choose the right-most)
-        p = &hull->points[hull->pointCount + i];
-        if ((p->y < p0->y) ||
-            (fabs(p->y - p0->y) <= FLT_EPSILON && p->x > p0->x))
+    // find the point in the boundary list
+    for (k = 0; k < hull->boundaryCount; ++k)
+    {
+        if (hull->boundaryIdx[k].pointIdx == pointIdx)
         {
-            p0 = p;
-            hull->lowestIdx = hull->boundaryCount + i;
+            break;
         }
     }
 
-    // Update point count
-    hull->pointCount += count;
-    hull->boundaryCount += count;
+    // Points dropped from the boundary list never affect the hull. Removing a
+    // vertex of a computed hull repairs only the pocket it leaves behind,
+    // otherwise points dropped by an earlier computation may be needed again.
+    rebuild = FALSE;
+    if (k < hull->boundaryCount)
+    {
+        if (hull->dirty || !hull2d_removeVertex(hull, k))
+        {
+            rebuild = TRUE;
+        }
+    }
+
+    // the removed point may have been extreme, they are found again among the
+    // vertices of a computed hull below, otherwise by the cull or the engine
+    hull->extremesValid = FALSE;
+
+    // move the last point into the freed slot
+    last = hull->pointCount - 1;
+    hull->points[pointIdx] = hull->points[last];
+    hull->pointCount = last;
+    for (i = 0; i < hull->boundaryCount; ++i)
+    {
+        if (hull->boundaryIdx[i].pointIdx == last)
+        {
+            hull->boundaryIdx[i].pointIdx = pointIdx;
+        }
+    }
+
+    if (rebuild)
+    {
+        hull->dirty = TRUE;
+        hull->boundaryCount = hull->pointCount;
+        for (i = 0; i < hull->pointCount; ++i)
+        {
+            hull->boundaryIdx[i].pointIdx = i;
+            hull->boundaryIdx[i].remove = FALSE;
+        }
+        hull->lowestIdx = 0;
+        if (hull->boundaryCount > 0)
+        {
+            hull2d_findLowest(hull);
+        }
+    }
+    else if (!hull->dirty)
+    {
+        hull2d_findExtremes(hull);
+    }
+
+    return TRUE;
+}
+
+/**
+* @brief Same as hull2d_areaSign with a caller supplied tolerance on twice the
+*        area of the triangle
+* @param[in] a Pointer to first point of triangle
+* @param[in] b Pointer to second point of triangle
+* @param[in] c Pointer to third point of triangle
+* @param[in] tolerance Triangles with smaller area are treated as a line
+*/
+static int32_t hull2d_areaSignTol(const Point2f* a, const Point2f* b,
+    const Point2f* c, double tolerance)
+{
+    double area2;
+
+    area2 = ((double)b->x - a->x) * ((double)c->y - a->y) -
+            ((double)c->x - a->x) * ((double)b->y - a->y);
+
+    if      (area2 >  tolerance) return  1;
+    else if (area2 < -tolerance) return -1;
+    else                         return  0;
 }
 
 /**
@@ -127,14 +484,7 @@ void hull2d_addPoints(hull2d_t* hull, const Point2f* points, uint32_t count)
 static int32_t hull2d_areaSign(const Point2f* a, const Point2f* b,
     const Point2f* c)
 {
-    double area2;
-
-    area2 = (double)( b->x - a->x ) * (double)( c->y - a->y ) -
-            (double)( c->x - a->x ) * (double)( b->y - a->y );
-
-    if      (area2 >  FLT_EPSILON) return  1;
-    else if (area2 < -FLT_EPSILON) return -1;
-    else                          return  0;
+    return hull2d_areaSignTol(a, b, c, FLT_EPSILON);
 }
 
 /**
@@ -150,422 +500,3174 @@ static bool_t hull2d_left(const Point2f* a, const Point2f* b, const Point2f* c)
 }
 
 /**
-* @brief Return true if point c is left of or on ab
-* @param[in] a Back of the vector (one point on the line)
-* @param[in] b End of the vector (second point on the line)
-* @param[in] c Point to test
-* @return Return true if a < b and false otherwise
+* @brief Index of the lowest set bit
+* @param[in] mask A non-zero bit mask
 */
-static bool_t hull2d_leftOn(const Point2f* a, const Point2f* b,
-    const Point2f* c)
-{   
-    return hull2d_areaSign(a, b, c) >= 0;
+static uint32_t hull2d_lowestBit(uint64_t mask)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctzll(mask);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long bit;
+    _BitScanForward64(&bit, mask);
+    return (uint32_t)bit;
+#else
+    uint32_t bit = 0;
+    while ((mask & 1U) == 0)
+    {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
 }
 
 /**
-* @brief Return true if all 3 points are on the same line
-* @param[in] a Back of the vector (one point on the line)
-* @param[in] b End of the vector (second point on the line)
-* @param[in] c Point to test
-* @return Return true if a < b and false otherwise
+* @brief hull2d_areaSign(a, b, p) for up to 64 points, one at a time
+* @param[in] points  The point list
+* @param[in] indices Points to test, NULL to test points[0, count)
+* @param[in] count   Number of points to test, at most HULL2D_SIGN_BLOCK
+* @param[in] a       Back of the vector
+* @param[in] b       End of the vector
+* @param[out] left   Bit i is set if point i is strictly left of ab
+* @param[out] right  Bit i is set if point i is strictly right of ab
 */
-static bool_t hull2d_collinear(const Point2f* a, const Point2f* b,
-    const Point2f* c)
+static void hull2d_areaSignsScalar(const Point2f* points,
+    const flaggedindex_t* indices, uint32_t count, const Point2f* a,
+    const Point2f* b, uint64_t* left, uint64_t* right)
 {
-    return hull2d_areaSign(a, b, c) == 0;
+    uint32_t i;
+    int32_t sign;
+
+    *left = 0;
+    *right = 0;
+    for (i = 0; i < count; ++i)
+    {
+        sign = hull2d_areaSign(a, b,
+            &points[indices != NULL ? indices[i].pointIdx : i]);
+        *left  |= (uint64_t)(sign > 0) << i;
+        *right |= (uint64_t)(sign < 0) << i;
+    }
 }
 
+#ifdef HULL2D_AVX2
+
 /**
-* @brief Compare c to ab
-*        if c is strictly left of ab then return false
-*        if c is strictly right of ab then return true
-*        if c is on the line defined by ab then
-*                |b - a| < |c - a| -> return true and mark b for deletion
-*                |c - a| < |b - a| -> return false and mark c for deletion
-*                and mark the c or b to remove (whichever is greater)
-*        if b and c are colocated -> return false and one for removal
-* @param[in] hull     Pointer to hull object
-* @param[in] a        Origin to compare about
-* @param[in/out] bidx index of first point to compare
-* @param[in/out] cidx index of second point to compare
+* @brief Return true if the processor and operating system support AVX2
 */
-static bool_t hull2d_compareAndFlag(hull2d_t* hull, const Point2f* a,
-    flaggedindex_t* bidx, flaggedindex_t* cidx)
+static bool_t hull2d_cpuHasAvx2(void)
 {
-    Point2f *b, *c;
+#ifdef _MSC_VER
+    int info[4];
 
-    if (bidx->pointIdx == cidx->pointIdx)
+    __cpuid(info, 0);
+    if (info[0] < 7)
     {
         return FALSE;
     }
 
-    b = &hull->points[bidx->pointIdx];
-    c = &hull->points[cidx->pointIdx];
-
-    int areaSign;
-    areaSign = hull2d_areaSign( a, b, c );
-    if (areaSign > 0)
-    {
-        return TRUE;
-    }
-    else if (areaSign < 0)
+    // AVX and OSXSAVE, then the OS must save the ymm registers
+    __cpuid(info, 1);
+    if ((info[2] & (3 << 27)) != (3 << 27) || (_xgetbv(0) & 6) != 6)
     {
         return FALSE;
     }
-    else
-    {
-        // a,b,c are collinear
-        float dx = fabsf(b->x - a->x) - fabsf(c->x - a->x);
-        float dy = fabsf(b->y - a->y) - fabsf(c->y - a->y);
-        if (dx < -FLT_EPSILON || dy < -FLT_EPSILON)
-        {
-            bidx->remove = TRUE;
-            return FALSE;
-        }
-        else if (dx > FLT_EPSILON || dy > FLT_EPSILON)
-        {
-            cidx->remove = TRUE;
-            return TRUE;
-        }
-        else
-        {
-            // remove the earlier of the two
-            if (bidx->pointIdx > cidx->pointIdx)
-            {
-                bidx->remove = TRUE;
-            }
-            else 
-            {
-                cidx->remove = TRUE;
-            }
-            return FALSE;
-        }
-    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
 }
 
 /**
-* @brief Sort the points in the hull structure relative angle to lowest point
-* @param hull Pointer to the hull structure
+* @brief Return true if the AVX2 kernels should be used, the processor is only
+*        checked on the first call
 */
-static void hull2d_sort(hull2d_t* hull)
+static bool_t hull2d_useAvx2(void)
 {
-    // define the less than routine for the QSORT macro
-#define hull2d_sort_lt(a,b) hull2d_compareAndFlag(hull, p0, a, b)
-
-    uint32_t        pcount;
-    flaggedindex_t* indices;
-    flaggedindex_t  temp;
-    Point2f*        p0;
+    // every thread stores the same answer so the race is harmless
+    static volatile int32_t hasAvx2 = -1;
 
-    // move the reference to the lowest point to the front
-    temp = hull->boundaryIdx[0];
-    hull->boundaryIdx[0] = hull->boundaryIdx[hull->lowestIdx];
-    hull->boundaryIdx[hull->lowestIdx] = temp;
-    hull->lowestIdx = 0;
-
-    // get parameters for sorting ready
-    indices = &hull->boundaryIdx[1];
-    pcount  =  hull->boundaryCount - 1;
-    p0      = &hull->points[hull->boundaryIdx[0].pointIdx];
+    if (hasAvx2 < 0)
+    {
+        hasAvx2 = hull2d_cpuHasAvx2() ? 1 : 0;
+    }
+    return hasAvx2 > 0;
+}
 
-    // sort
-    QSORT(flaggedindex_t, indices, pcount, hull2d_sort_lt);
+/**
+* @brief Split 8 points loaded as (x, y) pairs into their x and y coordinates
+* @param[in] lo  The first 4 points
+* @param[in] hi  The last 4 points
+* @param[out] x  Receives the x coordinates in order
+* @param[out] y  Receives the y coordinates in order
+*/
+HULL2D_TARGET_AVX2
+static void hull2d_splitXY(__m256 lo, __m256 hi, __m256* x, __m256* y)
+{
+    // the shuffle interleaves the 128 bit halves, the permute restores them
+    *x = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+        _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))), 0xD8));
+    *y = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(
+        _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))), 0xD8));
 }
 
 /**
-* @brief Remove all the indices marked for removal, tightening the list
-* @param[in/out] hull Pointer to the hull object
+* @brief Load both coordinates of a point as the bits of one double, scalar
+*        loads beat the AVX2 gather instructions for scattered points
+* @param[in] p Pointer to the point
 */
-static void hull2d_squash(hull2d_t* hull)
+static double hull2d_loadPair(const Point2f* p)
 {
-    uint32_t i, j;
-    i = 0; j = 0;
-    while (i < hull->boundaryCount)
-    {
-        if (!hull->boundaryIdx[i].remove)
-        {
-            if (i != j)
-            {
-                hull->boundaryIdx[j] = hull->boundaryIdx[i];
-            }
-            ++j;
-        }
-        ++i;
-    }
-    hull->boundaryCount = j;
+    double bits;
+    memcpy(&bits, p, sizeof(bits));
+    return bits;
 }
 
 /**
-* @brief The last step of Graham's algorithm, build the convex hull and store
-*        the result in the stack.
-* @param[in] hull   Pointer to the hull object
-* @param[out] stack Will contain indices of points on hull when done
+* @brief Same as hull2d_areaSignsScalar 8 points per iteration. Coordinates
+*        are widened to double before they are subtracted, so the signs match
+*        hull2d_areaSign exactly.
+* @param[in] points  The point list
+* @param[in] indices Points to test, NULL to test points[0, count)
+* @param[in] count   Number of points to test, at most HULL2D_SIGN_BLOCK
+* @param[in] a       Back of the vector
+* @param[in] b       End of the vector
+* @param[out] left   Bit i is set if point i is strictly left of ab
+* @param[out] right  Bit i is set if point i is strictly right of ab
 */
-void hull2d_grahams(const hull2d_t* hull, stack_t* stack)
+HULL2D_TARGET_AVX2
+static void hull2d_areaSignsAvx2(const Point2f* points,
+    const flaggedindex_t* indices, uint32_t count, const Point2f* a,
+    const Point2f* b, uint64_t* left, uint64_t* right)
 {
+    __m256 lo, hi, x, y;
+    __m256d ax, ay, ex, ey, eps, neps, area2;
+    uint64_t l, r;
     uint32_t i;
-    flaggedindex_t p1idx, p2idx, p3idx;
-    const Point2f *p1, *p2, *p3;
 
-    // clear the stack
-    stack_clear(stack);
+    ax = _mm256_set1_pd(a->x);
+    ay = _mm256_set1_pd(a->y);
+    ex = _mm256_set1_pd((double)b->x - a->x);
+    ey = _mm256_set1_pd((double)b->y - a->y);
+    eps = _mm256_set1_pd(FLT_EPSILON);
+    neps = _mm256_set1_pd(-FLT_EPSILON);
 
-    // push the first two onto the stack, these will never be removed
-    (void)stack_push(stack, &hull->boundaryIdx[0]);
-    (void)stack_push(stack, &hull->boundaryIdx[1]);
-
-    i = 2U;
-    while (i < hull->boundaryCount)
+    l = 0;
+    r = 0;
+    for (i = 0; i + 8 <= count; i += 8)
     {
-        // grab the top two points on the stack
-        LOGASSERT(stack_peek(stack, 1, &p1idx));
-        LOGASSERT(stack_peek(stack, 0, &p2idx));
-
-        p1 = &hull->points[p1idx.pointIdx];
-        p2 = &hull->points[p2idx.pointIdx];
+        // load 8 points as (x, y) pairs
+        if (indices != NULL)
+        {
+            lo = _mm256_castpd_ps(_mm256_setr_pd(
+                hull2d_loadPair(&points[indices[i + 0].pointIdx]),
+                hull2d_loadPair(&points[indices[i + 1].pointIdx]),
+                hull2d_loadPair(&points[indices[i + 2].pointIdx]),
+                hull2d_loadPair(&points[indices[i + 3].pointIdx])));
+            hi = _mm256_castpd_ps(_mm256_setr_pd(
+                hull2d_loadPair(&points[indices[i + 4].pointIdx]),
+                hull2d_loadPair(&points[indices[i + 5].pointIdx]),
+                hull2d_loadPair(&points[indices[i + 6].pointIdx]),
+                hull2d_loadPair(&points[indices[i + 7].pointIdx])));
+        }
+        else
+        {
+            lo = _mm256_loadu_ps(&points[i].x);
+            hi = _mm256_loadu_ps(&points[i + 4].x);
+        }
 
-        p3idx = hull->boundaryIdx[i];
-        p3 = &hull->points[p3idx.pointIdx];
+        hull2d_splitXY(lo, hi, &x, &y);
+
+        // four lanes at a time in double precision
+        area2 = _mm256_sub_pd(
+            _mm256_mul_pd(ex, _mm256_sub_pd(
+                _mm256_cvtps_pd(_mm256_castps256_ps128(y)), ay)),
+            _mm256_mul_pd(_mm256_sub_pd(
+                _mm256_cvtps_pd(_mm256_castps256_ps128(x)), ax), ey));
+        l |= (uint64_t)_mm256_movemask_pd(
+            _mm256_cmp_pd(area2, eps, _CMP_GT_OQ)) << i;
+        r |= (uint64_t)_mm256_movemask_pd(
+            _mm256_cmp_pd(area2, neps, _CMP_LT_OQ)) << i;
+
+        area2 = _mm256_sub_pd(
+            _mm256_mul_pd(ex, _mm256_sub_pd(
+                _mm256_cvtps_pd(_mm256_extractf128_ps(y, 1)), ay)),
+            _mm256_mul_pd(_mm256_sub_pd(
+                _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), ax), ey));
+        l |= (uint64_t)_mm256_movemask_pd(
+            _mm256_cmp_pd(area2, eps, _CMP_GT_OQ)) << (i + 4);
+        r |= (uint64_t)_mm256_movemask_pd(
+            _mm256_cmp_pd(area2, neps, _CMP_LT_OQ)) << (i + 4);
+    }
 
-        // if the path (p1, p1, p3) curves left then add p3
-        if ( hull2d_left(p1, p2, p3) )
+    // fewer than 8 points left
+    if (i < count)
+    {
+        if (indices != NULL)
         {
-            (void)stack_push(stack, &p3idx);
-            i++;
+            hull2d_areaSignsScalar(points, &indices[i], count - i, a, b,
+                left, right);
         }
         else
         {
-            LOGASSERT(stack_pop(stack));
+            hull2d_areaSignsScalar(&points[i], NULL, count - i, a, b,
+                left, right);
         }
+        l |= *left << i;
+        r |= *right << i;
     }
+
+    *left = l;
+    *right = r;
 }
 
+#endif
+
 /**
-* @brief Copy points from the stack into the list of hull points
-* @param[in/out] hull  Pointer to the hull object
-* @param[in/out] stack Pointer to stack containing indices of points that make
-*                      up hull boundary.
+* @brief hull2d_areaSign(a, b, p) for up to 64 points, using AVX2 when the
+*        processor supports it
+* @param[in] points  The point list
+* @param[in] indices Points to test, NULL to test points[0, count)
+* @param[in] count   Number of points to test, at most HULL2D_SIGN_BLOCK
+* @param[in] a       Back of the vector
+* @param[in] b       End of the vector
+* @param[out] left   Bit i is set if point i is strictly left of ab
+* @param[out] right  Bit i is set if point i is strictly right of ab
+*/
+static void hull2d_areaSigns(const Point2f* points,
+    const flaggedindex_t* indices, uint32_t count, const Point2f* a,
+    const Point2f* b, uint64_t* left, uint64_t* right)
+{
+#ifdef HULL2D_AVX2
+    if (hull2d_useAvx2())
+    {
+        hull2d_areaSignsAvx2(points, indices, count, a, b, left, right);
+        return;
+    }
+#endif
+    hull2d_areaSignsScalar(points, indices, count, a, b, left, right);
+}
+
+/**
+* @brief Move the indices of points strictly right of ab to the front of the
+*        list, the order of the rest is not kept
+* @param[in] hull        Pointer to the hull object
+* @param[in] a           Back of the vector
+* @param[in] b           End of the vector
+* @param[in/out] indices First index of the list
+* @param[in] count       Number of indices in the list
+* @return Number of indices moved to the front
 */
-void hull2d_copyStack(hull2d_t* hull, stack_t* stack)
+static uint32_t hull2d_partitionRight(const hull2d_t* hull, const Point2f* a,
+    const Point2f* b, flaggedindex_t* indices, uint32_t count)
 {
-    int32_t n = stack_count(stack);
+    uint64_t left, right;
+    uint32_t i, n, w;
 
-    int32_t i;
-    for (i = n-1; i >= 0; --i)
+    // a swap never moves an index past the one being looked at, so the
+    // signs of a block stay valid while it is partitioned
+    w = 0;
+    for (i = 0; i < count; i += n)
     {
-        LOGASSERT(stack_peek(stack, 0, & hull->boundaryIdx[i]));
-        (void)stack_pop(stack);
+        n = (count - i < HULL2D_SIGN_BLOCK) ? count - i : HULL2D_SIGN_BLOCK;
+        hull2d_areaSigns(hull->points, &indices[i], n, a, b, &left, &right);
+        while (right != 0)
+        {
+            hull2d_swap(&indices[i + hull2d_lowestBit(right)], &indices[w++]);
+            right &= right - 1;
+        }
     }
 
-    hull->boundaryCount = n;
+    return w;
+}
 
-    LOGASSERT(stack_count(stack) == 0);
+/**
+* @brief Value of a point in one of the HULL2D_DIRECTIONS directions, the
+*        extreme point in a direction has the largest value
+* @param[in] p Pointer to the point
+* @param[in] k The direction
+*/
+static float hull2d_extremeValue(const Point2f* p, uint32_t k)
+{
+    return hull2d_dirX[k] * p->x + hull2d_dirY[k] * p->y;
 }
 
 /**
-* @brief Compute the hull using the points in the hull's point list
+* @brief Update the cached extreme points with a new point, the earlier point
+*        is kept when two are equally extreme
 * @param[in/out] hull Pointer to the hull object
-* @param[in/out] stack A stack of uint32_t large enough to store indicies to
-*                all points. Will be used as scratch space.
-* @return Returns true if able to create a hull false otherwise, only fails if
-*         two or less points are in the hull or all points fall on same line.
+* @param[in] pointIdx Index of the new point
 */
-bool_t hull2d_computeHull(hull2d_t* hull, stack_t* stack)
+static void hull2d_updateExtremes(hull2d_t* hull, uint32_t pointIdx)
 {
-    // Compute the hull using Graham's algorithm O(n log(n))
+    const Point2f* p = &hull->points[pointIdx];
+    uint32_t k;
 
-    // nothing to do
-    if (hull->dirty == FALSE)
+    for (k = 0; k < HULL2D_DIRECTIONS; ++k)
     {
-        return TRUE;
+        if (hull2d_extremeValue(p, k) >
+            hull2d_extremeValue(&hull->points[hull->extremeIdx[k]], k))
+        {
+            hull->extremeIdx[k] = pointIdx;
+        }
     }
+}
 
-    LOGASSERT(stack->itemSize == sizeof(flaggedindex_t));
-    LOGASSERT(stack->maxItems >= MAX_POINTS_PER_HULL);
+/**
+* @brief Find the cached extreme points again among the vertices of a computed
+*        hull, the extreme point in every direction is one of them
+* @param[in/out] hull Pointer to a computed hull
+*/
+static void hull2d_findExtremes(hull2d_t* hull)
+{
+    uint32_t i, k;
 
-    // verify there are enough points to build a hull
-    if (hull->boundaryCount < 3)
+    for (k = 0; k < HULL2D_DIRECTIONS; ++k)
     {
-        return FALSE;
+        hull->extremeIdx[k] = hull->boundaryIdx[0].pointIdx;
     }
+    for (i = 1; i < hull->boundaryCount; ++i)
+    {
+        hull2d_updateExtremes(hull, hull->boundaryIdx[i].pointIdx);
+    }
+    hull->extremesValid = TRUE;
+}
 
-    // Sort by angle from the lowest point (relative to +x vector)
-    hull2d_sort(hull);
+/**
+* @brief Return true if p should replace p0 as the lowest point, points level
+*        with p0 to within FLT_EPSILON replace it when they are further right
+* @param[in] p  The new point
+* @param[in] p0 The current lowest point
+*/
+static bool_t hull2d_lower(const Point2f* p, const Point2f* p0)
+{
+    return (p->y < p0->y) ||
+           (fabs(p->y - p0->y) <= FLT_EPSILON && p->x > p0->x);
+}
 
-    // Remove points marked for removal
-    hull2d_squash(hull);
+/**
+* @brief Reference new points from the boundary list and track the lowest and
+*        extreme points, one point at a time
+* @param[in/out] hull Pointer to the hull object, the new points follow its
+*                     pointCount points and their indices follow its
+*                     boundaryCount indices
+* @param[in] first    First new point to ingest
+* @param[in] count    Number of new points to ingest
+*/
+static void hull2d_ingestScalar(hull2d_t* hull, uint32_t first,
+    uint32_t count)
+{
+    uint32_t i, pointIdx;
+    const Point2f *p0, *p;
 
-    // verify there are still enough points to build a hull
-    if (hull->boundaryCount < 3)
+    p0 = &hull->points[hull->boundaryIdx[hull->lowestIdx].pointIdx];
+    for (i = first; i < first + count; ++i)
     {
-        return FALSE;
+        // add a reference to the new point in the boundaryIdx list
+        pointIdx = hull->pointCount + i;
+        hull->boundaryIdx[hull->boundaryCount + i].pointIdx = pointIdx;
+        hull->boundaryIdx[hull->boundaryCount + i].remove = FALSE;
+
+        // Keep track of lowest point (if same choose the right-most)
+        p = &hull->points[pointIdx];
+        if (hull2d_lower(p, p0))
+        {
+            p0 = p;
+            hull->lowestIdx = hull->boundaryCount + i;
+        }
+
+        if (hull->extremesValid)
+        {
+            hull2d_updateExtremes(hull, pointIdx);
+        }
     }
+}
 
-    // Run grahams algorithm
-    hull2d_grahams(hull, stack);
+#ifdef HULL2D_AVX2
 
-    // Copy data from stack back to hull indices
-    hull2d_copyStack(hull, stack);
+/**
+* @brief Keep the larger value of every lane and the index it came from, the
+*        earlier index when they are equal
+* @param[in] v          Values of the new points
+* @param[in] lane       Indices of the new points
+* @param[in/out] best   Largest value of every lane
+* @param[in/out] bestIdx Index of the largest value of every lane
+*/
+HULL2D_TARGET_AVX2
+static void hull2d_trackMax(__m256 v, __m256i lane, __m256* best,
+    __m256i* bestIdx)
+{
+    __m256 mask = _mm256_cmp_ps(v, *best, _CMP_GT_OQ);
+    *best = _mm256_blendv_ps(*best, v, mask);
+    *bestIdx = _mm256_castps_si256(_mm256_blendv_ps(
+        _mm256_castsi256_ps(*bestIdx), _mm256_castsi256_ps(lane), mask));
+}
 
-    hull->dirty = false;
+/**
+* @brief Same as hull2d_trackMax for the smallest value
+*/
+HULL2D_TARGET_AVX2
+static void hull2d_trackMin(__m256 v, __m256i lane, __m256* best,
+    __m256i* bestIdx)
+{
+    __m256 mask = _mm256_cmp_ps(v, *best, _CMP_LT_OQ);
+    *best = _mm256_blendv_ps(*best, v, mask);
+    *bestIdx = _mm256_castps_si256(_mm256_blendv_ps(
+        _mm256_castsi256_ps(*bestIdx), _mm256_castsi256_ps(lane), mask));
+}
 
-    return TRUE;
+/**
+* @brief Fold the lanes of hull2d_trackMax or hull2d_trackMin into a cached
+*        extreme point, the earliest point wins when several are equal
+* @param[in/out] hull Pointer to the hull object
+* @param[in] d        Direction of the cached extreme point
+* @param[in] base     Direction whose value the lanes hold, d or its opposite
+* @param[in] best     Value of every lane
+* @param[in] bestIdx  Index of every lane
+*/
+HULL2D_TARGET_AVX2
+static void hull2d_foldExtreme(hull2d_t* hull, uint32_t d, uint32_t base,
+    __m256 best, __m256i bestIdx)
+{
+    float value[8];
+    uint32_t index[8];
+    uint32_t j;
+    float ref;
+
+    _mm256_storeu_ps(value, best);
+    _mm256_storeu_si256((__m256i*)index, bestIdx);
+    for (j = 0; j < 8; ++j)
+    {
+        ref = hull2d_extremeValue(&hull->points[hull->extremeIdx[d]], base);
+        if (((d == base) ? value[j] > ref : value[j] < ref) ||
+            (value[j] == ref && index[j] < hull->extremeIdx[d]))
+        {
+            hull->extremeIdx[d] = index[j];
+        }
+    }
 }
 
 /**
-* @brief Check if two line segments (a0, a1) and (b0, b1) intersect
-* @param[in] a0 An endpoint of the first line segement
-* @param[in] a1 An endpoint of the first line segement
-* @param[in] b0 An endpoint of the second line segement
-* @param[in] b1 An endpoint of the second line segement
-* @return Returns TRUE if the segements intersect, FALSE otherwise
+* @brief Update the cached extreme points from new points, 8 points per
+*        iteration. Every lane keeps its own extremes, so the result matches
+*        hull2d_updateExtremes.
+* @param[in/out] hull Pointer to the hull object
+* @param[in] first    Index of the first new point
+* @param[in] count    Number of new points, a multiple of 8
+* @param[in] diagonal False for the y and x directions, true for the x-y and
+*                     x+y directions. The opposite direction has exactly the
+*                     negated value so it is found as the minimum.
 */
-bool_t hull2d_segSegIntersect(const Point2f* a0, const Point2f* a1,
-    const Point2f* b0, const Point2f* b1)
+HULL2D_TARGET_AVX2
+static void hull2d_extremesAvx2(hull2d_t* hull, uint32_t first,
+    uint32_t count, bool_t diagonal)
 {
-    double s, t;
-    double num, denom;
+    const uint32_t half = HULL2D_DIRECTIONS / 2;
+    const Point2f* points = &hull->points[first];
+    __m256 hi0, hi1, lo0, lo1, x, y, v0, v1;
+    __m256i hiIdx0, hiIdx1, loIdx0, loIdx1, lane;
+    uint32_t dir0, dir1, i;
+
+    // +y and +x, or +x-y and +x+y in hull2d_dirX/hull2d_dirY
+    dir0 = diagonal ? 1U : 4U;
+    dir1 = diagonal ? 3U : 2U;
+
+    hi0 = _mm256_set1_ps(hull2d_extremeValue(
+        &hull->points[hull->extremeIdx[dir0]], dir0));
+    hi1 = _mm256_set1_ps(hull2d_extremeValue(
+        &hull->points[hull->extremeIdx[dir1]], dir1));
+    lo0 = _mm256_set1_ps(hull2d_extremeValue(
+        &hull->points[hull->extremeIdx[(dir0 + half) % 8]], dir0));
+    lo1 = _mm256_set1_ps(hull2d_extremeValue(
+        &hull->points[hull->extremeIdx[(dir1 + half) % 8]], dir1));
+    hiIdx0 = _mm256_set1_epi32((int32_t)hull->extremeIdx[dir0]);
+    hiIdx1 = _mm256_set1_epi32((int32_t)hull->extremeIdx[dir1]);
+    loIdx0 = _mm256_set1_epi32((int32_t)hull->extremeIdx[(dir0 + half) % 8]);
+    loIdx1 = _mm256_set1_epi32((int32_t)hull->extremeIdx[(dir1 + half) % 8]);
+
+    lane = _mm256_add_epi32(_mm256_set1_epi32((int32_t)first),
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    for (i = 0; i < count; i += 8)
+    {
+        hull2d_splitXY(_mm256_loadu_ps(&points[i].x),
+            _mm256_loadu_ps(&points[i + 4].x), &x, &y);
+        v0 = diagonal ? _mm256_sub_ps(x, y) : y;
+        v1 = diagonal ? _mm256_add_ps(x, y) : x;
 
-    denom = (double)a0->x * (double)( b1->y - b0->y ) +
-            (double)a1->x * (double)( b0->y - b1->y ) +
-            (double)b1->x * (double)( a1->y - a0->y ) +
-            (double)b0->x * (double)( a0->y - a1->y );
+        hull2d_trackMax(v0, lane, &hi0, &hiIdx0);
+        hull2d_trackMin(v0, lane, &lo0, &loIdx0);
+        hull2d_trackMax(v1, lane, &hi1, &hiIdx1);
+        hull2d_trackMin(v1, lane, &lo1, &loIdx1);
 
-    // check if segements are parallel (don't intersect)
-    if (fabs(denom) < FLT_EPSILON)
+        lane = _mm256_add_epi32(lane, _mm256_set1_epi32(8));
+    }
+
+    hull2d_foldExtreme(hull, dir0, dir0, hi0, hiIdx0);
+    hull2d_foldExtreme(hull, dir1, dir1, hi1, hiIdx1);
+    hull2d_foldExtreme(hull, (dir0 + half) % 8, dir0, lo0, loIdx0);
+    hull2d_foldExtreme(hull, (dir1 + half) % 8, dir1, lo1, loIdx1);
+}
+
+/**
+* @brief Check that an index with a clear flag is stored as the bare point
+*        index, the layout of bit-fields is up to the compiler
+* @return Returns true if indices can be written as 32 bit integers
+*/
+static bool_t hull2d_indexIsWord(void)
+{
+    flaggedindex_t probe;
+    uint32_t word;
+
+    if (sizeof(flaggedindex_t) != sizeof(uint32_t))
     {
         return FALSE;
     }
 
-    num = (double)a0->x * (double)( b1->y - b0->y ) +
-          (double)b0->x * (double)( a0->y - b1->y ) +
-          (double)b1->x * (double)( b0->y - a0->y );
-    s = num / denom;
-
-    num = -( (double)a0->x * (double)( b0->y - a1->y ) +
-             (double)a1->x * (double)( a0->y - b0->y ) +
-             (double)b0->x * (double)( a1->y - a0->y ) );
-    t = num / denom;
-    
-    // intersection point is
-    // x = a0->x + s * (a1->x - a0->x)
-    // y = a0->y + t * (a1->y - a0->y)
+    probe.pointIdx = 1;
+    probe.remove = FALSE;
+    memcpy(&word, &probe, sizeof(word));
 
-    // Intersects if s and t are both between 0 and 1
-    return ( (0.0 <= s) && (s <= 1.0) && (0.0 <= t) && (t <= 1.0) );
+    return (word == 1);
 }
 
 /**
-* @brief Check if a point is inside a convex hull
-* @param[in] hull Pointer to the hull
-* @param[in] p    Pointer to the point
-* @return Returns TRUE if the point is inside the hull, FALSE otherwise
+* @brief Same as hull2d_ingestScalar 8 points per iteration. The indices are
+*        written with vector stores and blocks with no point level with or
+*        below the lowest point skip the lowest point test, the extremes are
+*        found in two more passes over the new points.
+* @param[in/out] hull Pointer to the hull object, the new points follow its
+*                     pointCount points and their indices follow its
+*                     boundaryCount indices
+* @param[in] count    Number of new points to ingest
 */
-bool_t hull2d_pointInHull(const hull2d_t* hull, const Point2f* p)
+HULL2D_TARGET_AVX2
+static void hull2d_ingestAvx2(hull2d_t* hull, uint32_t count)
 {
-    // Point must be to left of all segements
-    uint32_t i, j;
-    const Point2f *p0, *p1;
-    p0 = &hull->points[hull->boundaryIdx[0].pointIdx];
-    for (i = 0; i < hull->boundaryCount; ++i)
+    const uint32_t first = hull->pointCount;
+    const Point2f* points = &hull->points[first];
+    flaggedindex_t* indices = &hull->boundaryIdx[hull->boundaryCount];
+    const bool_t packed = hull2d_indexIsWord();
+    __m256 x, y;
+    __m256i base;
+    uint32_t i, j, lowest;
+    const Point2f* p0;
+
+    // locals, the index stores could otherwise alias the hull's fields
+    lowest = hull->lowestIdx;
+    p0 = &hull->points[hull->boundaryIdx[lowest].pointIdx];
+
+    for (i = 0; i + 8 <= count; i += 8)
     {
-        j = (i + 1) % hull->boundaryCount;
-        p0 = &hull->points[hull->boundaryIdx[i].pointIdx];
-        p1 = &hull->points[hull->boundaryIdx[j].pointIdx];
-        if (!hull2d_leftOn(p0, p1, p))
+        // unflagged indices are plain point indices, 8 per store
+        if (packed)
         {
-            return FALSE;
+            base = _mm256_set1_epi32((int32_t)(first + i));
+            _mm256_storeu_si256((__m256i*)&indices[i], _mm256_add_epi32(
+                base, _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+        }
+        else
+        {
+            for (j = 0; j < 8; ++j)
+            {
+                indices[i + j].pointIdx = first + i + j;
+                indices[i + j].remove = FALSE;
+            }
+        }
+
+        // only a point at most FLT_EPSILON above the lowest can replace it
+        hull2d_splitXY(_mm256_loadu_ps(&points[i].x),
+            _mm256_loadu_ps(&points[i + 4].x), &x, &y);
+        if (_mm256_movemask_ps(_mm256_cmp_ps(
+                _mm256_sub_ps(y, _mm256_set1_ps(p0->y)),
+                _mm256_set1_ps(FLT_EPSILON), _CMP_LE_OQ)) != 0)
+        {
+            for (j = i; j < i + 8; ++j)
+            {
+                if (hull2d_lower(&points[j], p0))
+                {
+                    p0 = &points[j];
+                    lowest = hull->boundaryCount + j;
+                }
+            }
         }
-        p0 = p1;
     }
-    return TRUE;
+    hull->lowestIdx = lowest;
+
+    if (hull->extremesValid && i > 0)
+    {
+        hull2d_extremesAvx2(hull, first, i, FALSE);
+        hull2d_extremesAvx2(hull, first, i, TRUE);
+    }
+
+    // fewer than 8 points left
+    hull2d_ingestScalar(hull, i, count - i);
 }
 
+#endif
+
 /**
-* @brief Check if two convex hulls intersect
-* @param[in] h1 The first hull
-* @param[in] h2 The second hull
-* @return True if h1 intesects h2, false otherwise
+* @brief Reference new points from the boundary list and track the lowest and
+*        extreme points, using AVX2 when the processor supports it
+* @param[in/out] hull Pointer to the hull object, the new points follow its
+*                     pointCount points and their indices follow its
+*                     boundaryCount indices
+* @param[in] count    Number of new points
 */
-bool_t hull2d_checkIntersect(const hull2d_t* ha, const hull2d_t* hb)
+static void hull2d_ingest(hull2d_t* hull, uint32_t count)
 {
-    uint32_t idxA0, idxA1;
-    uint32_t idxB0, idxB1;
-    uint32_t aMax, bMax;
-    float crossMag;
-    bool_t aLeftB;
-    bool_t bLeftA;
-
-    const Point2f *a0, *a1;
-    const Point2f *b0, *b1;
+#ifdef HULL2D_AVX2
+    if (hull2d_useAvx2())
+    {
+        hull2d_ingestAvx2(hull, count);
+        return;
+    }
+#endif
+    hull2d_ingestScalar(hull, 0, count);
+}
 
-    // assert that hulls have been caluculated
-    LOGASSERT(!ha->dirty && !ha->dirty);
+/**
+* @brief Pseudo-angle of the vector (dx, dy) relative to the +x vector. Not an
+*        angle but increases monotonically with it, 0 at 0 and 2 at pi.
+* @param[in] dx X component of the vector
+* @param[in] dy Y component of the vector, clamped to the upper half plane
+* @param[in] l1 |dx| + |dy|, must not be zero
+*/
+static double hull2d_pseudoAngle(double dx, double dy, double l1)
+{
+    // points within FLT_EPSILON below the lowest point count as level with it
+    return (dy < 0.0) ? ((dx > 0.0) ? 0.0 : 2.0) : 1.0 - dx / l1;
+}
 
-    aMax = ha->boundaryCount;
-    bMax = hb->boundaryCount;
+/**
+* @brief Compute the sort key of every point relative to the lowest point,
+*        points colocated with the lowest point sort first. The differences
+*        are taken in double so they are exact for float points.
+* @param[in] hull Pointer to the hull structure
+* @param[out] keys Sort keys indexed by point index
+*/
+static void hull2d_extractKeys(const hull2d_t* hull, hull2d_sortkey_t* keys)
+{
+    uint32_t i;
+    double dx, dy, l1;
+    const flaggedindex_t* idx;
+    const Point2f *p0, *p;
 
-    idxA0 = 0;
-    idxB0 = 0;
-    do
+    p0 = &hull->points[hull->boundaryIdx[0].pointIdx];
+    for (i = 1; i < hull->boundaryCount; ++i)
     {
-        idxA1 = (idxA0 + 1) % aMax;
-        idxB1 = (idxB0 + 1) % bMax;
+        idx = &hull->boundaryIdx[i];
+        p = &hull->points[idx->pointIdx];
+        dx = (double)p->x - p0->x;
+        dy = (double)p->y - p0->y;
+        l1 = fabs(dx) + fabs(dy);
+        keys[idx->pointIdx].angle =
+            (l1 > 0.0) ? hull2d_pseudoAngle(dx, dy, l1) : -1.0;
+        keys[idx->pointIdx].dist = l1;
+    }
+}
 
-        a0 = &ha->points[ha->boundaryIdx[idxA0].pointIdx];
-        a1 = &ha->points[ha->boundaryIdx[idxA1].pointIdx];
-        b0 = &hb->points[hb->boundaryIdx[idxB0].pointIdx];
-        b1 = &hb->points[hb->boundaryIdx[idxB1].pointIdx];
+/**
+* @brief Put every run of indices whose keys are within HULL2D_KEY_TOLERANCE
+*        of their neighbours in exact angular order about the lowest point,
+*        points on the same ray from it by distance. The keys only decide the
+*        order of points whose angles are clearly apart, so the sort agrees
+*        with the orientation test of the scan.
+* @param[in/out] hull Pointer to the hull structure, sorted by key
+* @param[in] keys     Sort keys indexed by point index
+*/
+static void hull2d_orderRuns(hull2d_t* hull, const hull2d_sortkey_t* keys)
+{
+    // define the less than routine for the QSORT macro
+#define hull2d_orderRuns_lt(a,b) \
+    ( hull2d_areaSignTol(p0, &hull->points[(a)->pointIdx], \
+        &hull->points[(b)->pointIdx], HULL2D_EXACT) > 0 || \
+     (hull2d_areaSignTol(p0, &hull->points[(a)->pointIdx], \
+        &hull->points[(b)->pointIdx], HULL2D_EXACT) == 0 && \
+      keys[(a)->pointIdx].dist < keys[(b)->pointIdx].dist) )
+
+    uint32_t i, start;
+    flaggedindex_t* indices = hull->boundaryIdx;
+    const Point2f* p0 = &hull->points[indices[0].pointIdx];
+
+    start = 1;
+    for (i = 2; i <= hull->boundaryCount; ++i)
+    {
+        if (i < hull->boundaryCount &&
+            keys[indices[i].pointIdx].angle -
+            keys[indices[i - 1].pointIdx].angle <= HULL2D_KEY_TOLERANCE)
+        {
+            continue;
+        }
 
-        // test for two line segements intersecting
-        if (hull2d_segSegIntersect(a0, a1, b0, b1))
+        // points colocated with p0 have no direction, their order is kept
+        if (i - start > 1 && keys[indices[start].pointIdx].dist > 0.0)
         {
-            return TRUE;
+            QSORT(flaggedindex_t, &indices[start], i - start,
+                hull2d_orderRuns_lt);
         }
+        start = i;
+    }
+}
 
-        crossMag = (a1->x - a0->x) * (b1->y - b0->y) -
-                   (a1->y - a0->y) * (b1->x - b0->x);
+/**
+* @brief Map a double to an unsigned integer with the same ordering
+* @param[in] d The double
+*/
+static uint64_t hull2d_doubleBits(double d)
+{
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    return (u & 0x8000000000000000ULL) ? ~u : (u | 0x8000000000000000ULL);
+}
 
-        aLeftB = hull2d_left(b0, b1, a1);
-        bLeftA = hull2d_left(a0, a1, b1);
+/**
+* @brief Stable LSD radix sort of key/index pairs, one byte per pass. Passes
+*        where every key has the same byte are skipped.
+* @param[in/out] pairs Pairs to sort
+* @param[in/out] temp  Scratch space the same size as pairs
+* @param[in] count     Number of pairs
+* @return Pointer to whichever of pairs or temp holds the sorted result
+*/
+static hull2d_radixpair_t* hull2d_radixSort(hull2d_radixpair_t* pairs,
+    hull2d_radixpair_t* temp, uint32_t count)
+{
+    uint32_t offset[256];
+    uint32_t i, shift, digit, total, n;
+    hull2d_radixpair_t* swap;
 
-        // advance pointers
-        if (crossMag < -FLT_EPSILON)
+    for (shift = 0; shift < 64; shift += 8)
+    {
+        memset(offset, 0, sizeof(offset));
+        for (i = 0; i < count; ++i)
         {
-            if ( aLeftB )
-            {
-                idxB0++;
-            }
-            else
-            {
-                idxA0++;
-            }
+            offset[(pairs[i].key >> shift) & 0xFFU]++;
         }
-        else
+
+        // every key has the same digit, nothing to do
+        if (offset[(pairs[0].key >> shift) & 0xFFU] == count)
         {
-            if ( bLeftA )
-            {
-                idxA0++;
-            }
-            else
-            {
-                idxB0++;
-            }
+            continue;
         }
-    } while (idxA0 < aMax && idxB0 < bMax);
-    // If we got here then no edges intersect
 
-    // Check for case A subset of B
-    if (hull2d_pointInHull(hb, &ha->points[ha->boundaryIdx[0].pointIdx]))
+        // exclusive prefix sum gives the first slot of each digit
+        total = 0;
+        for (digit = 0; digit < 256; ++digit)
+        {
+            n = offset[digit];
+            offset[digit] = total;
+            total += n;
+        }
+
+        for (i = 0; i < count; ++i)
+        {
+            temp[offset[(pairs[i].key >> shift) & 0xFFU]++] = pairs[i];
+        }
+
+        swap = pairs;
+        pairs = temp;
+        temp = swap;
+    }
+
+    return pairs;
+}
+
+/**
+* @brief Sort the indices by angle key with a radix sort. Unlike the
+*        comparison sort distance is not used to break ties, hull2d_orderRuns
+*        puts equal and nearly equal keys in order afterwards.
+* @param[in/out] indices Indices to sort
+* @param[in] count       Number of indices
+* @param[in] keys        Sort keys indexed by point index
+* @param[in/out] pairs   Scratch space for count pairs
+* @param[in/out] temp    Scratch space for count pairs
+*/
+static void hull2d_radixSortKeys(flaggedindex_t* indices, uint32_t count,
+    const hull2d_sortkey_t* keys, hull2d_radixpair_t* pairs,
+    hull2d_radixpair_t* temp)
+{
+    uint32_t i;
+    hull2d_radixpair_t* sorted;
+    flaggedindex_t idx;
+
+    for (i = 0; i < count; ++i)
     {
-        return TRUE;
+        pairs[i].key = hull2d_doubleBits(keys[indices[i].pointIdx].angle);
+        pairs[i].pointIdx = indices[i].pointIdx;
     }
-    // Check for case B subset of A
-    else if (hull2d_pointInHull(ha, &hb->points[hb->boundaryIdx[0].pointIdx]))
+    sorted = hull2d_radixSort(pairs, temp, count);
+
+    // the sort never flags so every index is kept at this point, whole
+    // indices are written so the bit-fields aren't updated one at a time
+    idx.remove = FALSE;
+    for (i = 0; i < count; ++i)
     {
-        return TRUE;
+        idx.pointIdx = sorted[i].pointIdx;
+        indices[i] = idx;
     }
+}
 
-    // otherwise they don't intersect
-    return FALSE;
+/**
+* @brief Sort the points in the hull structure relative angle to lowest point
+* @param hull Pointer to the hull structure
+* @param keys Scratch space for one sort key per point
+* @param pairs Scratch space for two arrays of radix pairs, one per point, or
+*              NULL if only the comparison sort may be used
+*/
+static void hull2d_sort(hull2d_t* hull, hull2d_sortkey_t* keys,
+    hull2d_radixpair_t* pairs)
+{
+    // define the less than routine for the QSORT macro
+#define hull2d_sort_lt(a,b) \
+    ( keys[(a)->pointIdx].angle <  keys[(b)->pointIdx].angle || \
+     (keys[(a)->pointIdx].angle == keys[(b)->pointIdx].angle && \
+      keys[(a)->pointIdx].dist  <  keys[(b)->pointIdx].dist) )
+
+    uint32_t        pcount;
+    flaggedindex_t* indices;
+    flaggedindex_t  temp;
+
+    // move the reference to the lowest point to the front
+    temp = hull->boundaryIdx[0];
+    hull->boundaryIdx[0] = hull->boundaryIdx[hull->lowestIdx];
+    hull->boundaryIdx[hull->lowestIdx] = temp;
+    hull->lowestIdx = 0;
+
+    // compute every key once up front
+    hull2d_extractKeys(hull, keys);
+
+    // get parameters for sorting ready
+    indices = &hull->boundaryIdx[1];
+    pcount  =  hull->boundaryCount - 1;
+
+    // sort, large lists use a radix sort with no data dependent branches
+    if (pairs != NULL && pcount >= HULL2D_RADIX_THRESHOLD)
+    {
+        hull2d_radixSortKeys(indices, pcount, keys, pairs,
+            &pairs[MAX_POINTS_PER_HULL]);
+    }
+    else
+    {
+        QSORT(flaggedindex_t, indices, pcount, hull2d_sort_lt);
+    }
+
+    // equal and nearly equal keys by exact orientation, then distance
+    hull2d_orderRuns(hull, keys);
+}
+
+/**
+* @brief After sorting, flag points colocated with the lowest point and all
+*        but the farthest point of every ray from it for removal. The sort
+*        puts the points of a ray next to each other nearest first, so each
+*        point is only compared with the one before it.
+* @param[in/out] hull Pointer to the hull structure
+* @param[in] keys     Sort keys indexed by point index
+*/
+static void hull2d_flagCollinear(hull2d_t* hull, const hull2d_sortkey_t* keys)
+{
+    uint32_t i;
+    flaggedindex_t *prev, *idx;
+    const Point2f *p0, *pp, *p;
+
+    p0 = &hull->points[hull->boundaryIdx[0].pointIdx];
+    prev = NULL;
+    for (i = 1; i < hull->boundaryCount; ++i)
+    {
+        idx = &hull->boundaryIdx[i];
+        if (keys[idx->pointIdx].dist <= 0.0)
+        {
+            idx->remove = TRUE;
+            continue;
+        }
+
+        p = &hull->points[idx->pointIdx];
+        if (prev != NULL)
+        {
+            pp = &hull->points[prev->pointIdx];
+
+            // same direction from p0, not opposite directions
+            if (hull2d_areaSignTol(p0, pp, p, HULL2D_EXACT) == 0 &&
+                ((double)pp->x - p0->x) * ((double)p->x - p0->x) +
+                ((double)pp->y - p0->y) * ((double)p->y - p0->y) > 0.0)
+            {
+                prev->remove = TRUE;
+            }
+        }
+        prev = idx;
+    }
+}
+
+/**
+* @brief The last step of Graham's algorithm. Skips the indices marked for
+*        removal and builds the hull in place, the boundary list holds the
+*        chain so far in front of the read position.
+* @param[in/out] hull Pointer to the hull object, boundaryCount receives the
+*                     number of indices left
+*/
+static void hull2d_grahams(hull2d_t* hull)
+{
+    uint32_t i, n;
+    flaggedindex_t idx;
+    flaggedindex_t* chain = hull->boundaryIdx;
+    const Point2f *p1, *p2, *p3;
+
+    n = 0;
+    for (i = 0; i < hull->boundaryCount; ++i)
+    {
+        idx = chain[i];
+        if (idx.remove)
+        {
+            continue;
+        }
+        p3 = &hull->points[idx.pointIdx];
+
+        // pop until the path (p1, p2, p3) curves left, the lowest point is
+        // never removed. The test is exact like the order of the sort, with
+        // a tolerance the turns at the tip of a sliver look straight.
+        while (n >= 2)
+        {
+            p1 = &hull->points[chain[n - 2].pointIdx];
+            p2 = &hull->points[chain[n - 1].pointIdx];
+            if (hull2d_areaSignTol(p1, p2, p3, HULL2D_EXACT) > 0)
+            {
+                break;
+            }
+            n--;
+        }
+        chain[n++] = idx;
+    }
+
+    // then drop the turns within FLT_EPSILON of straight like the other
+    // engines, the ring is exactly convex so only those go
+    hull->boundaryCount = hull2d_dropStraight(hull, chain, n);
+}
+
+/**
+* @brief Sort a range of hull indices by x coordinate, breaking ties by y
+* @param[in/out] hull Pointer to the hull structure
+* @param[in/out] indices First index of the range
+* @param[in] count Number of indices in the range
+*/
+static void hull2d_sortXY(hull2d_t* hull, flaggedindex_t* indices,
+    uint32_t count)
+{
+    // define the less than routine for the QSORT macro
+#define hull2d_sortXY_lt(a,b) \
+    ( hull->points[(a)->pointIdx].x <  hull->points[(b)->pointIdx].x || \
+     (hull->points[(a)->pointIdx].x == hull->points[(b)->pointIdx].x && \
+      hull->points[(a)->pointIdx].y <  hull->points[(b)->pointIdx].y) )
+
+    QSORT(flaggedindex_t, indices, count, hull2d_sortXY_lt);
+}
+
+/**
+* @brief Find the lowest point in a range of indices (if same choose the
+*        right-most)
+* @param[in] hull Pointer to the hull object
+* @param[in] indices First index of the range
+* @param[in] count Number of indices in the range, must be at least one
+* @return Location of the lowest point relative to indices
+*/
+static uint32_t hull2d_lowestOf(const hull2d_t* hull,
+    const flaggedindex_t* indices, uint32_t count)
+{
+    uint32_t i, lowest;
+    const Point2f *p0, *p;
+
+    lowest = 0;
+    p0 = &hull->points[indices[0].pointIdx];
+    for (i = 1; i < count; ++i)
+    {
+        p = &hull->points[indices[i].pointIdx];
+        if (hull2d_lower(p, p0))
+        {
+            p0 = p;
+            lowest = i;
+        }
+    }
+    return lowest;
+}
+
+/**
+* @brief Find the lowest point in the boundary list and store its location in
+*        lowestIdx
+* @param[in/out] hull Pointer to the hull object
+*/
+static void hull2d_findLowest(hull2d_t* hull)
+{
+    hull->lowestIdx = hull2d_lowestOf(hull, hull->boundaryIdx,
+        hull->boundaryCount);
+}
+
+/**
+* @brief Reverse a range of the boundary list
+* @param[in/out] indices First index of the range
+* @param[in] count Number of indices in the range
+*/
+static void hull2d_reverse(flaggedindex_t* indices, uint32_t count)
+{
+    uint32_t i;
+    flaggedindex_t temp;
+    for (i = 0; i < count / 2; ++i)
+    {
+        temp = indices[i];
+        indices[i] = indices[count - 1 - i];
+        indices[count - 1 - i] = temp;
+    }
+}
+
+/**
+* @brief Rotate the boundary list left so location k comes first
+* @param[in/out] hull Pointer to the hull object
+* @param[in] k Location in the boundary list to move to the front
+*/
+static void hull2d_rotate(hull2d_t* hull, uint32_t k)
+{
+    if (k != 0)
+    {
+        hull2d_reverse(hull->boundaryIdx, k);
+        hull2d_reverse(&hull->boundaryIdx[k], hull->boundaryCount - k);
+        hull2d_reverse(hull->boundaryIdx, hull->boundaryCount);
+    }
+}
+
+/**
+* @brief Rotate the boundary list so the lowest point comes first, this keeps
+*        every engine consistent with the output of Graham's algorithm
+* @param[in/out] hull Pointer to the hull object
+*/
+static void hull2d_rotateToLowest(hull2d_t* hull)
+{
+    hull2d_findLowest(hull);
+    hull2d_rotate(hull, hull->lowestIdx);
+    hull->lowestIdx = 0;
+}
+
+/**
+* @brief Extend a monotone chain by point idx, popping every point that no
+*        longer makes a left turn
+* @param[in] hull      Pointer to the hull object
+* @param[in/out] chain The chains built so far
+* @param[in] idx       Index of the next point in the chain
+* @param[in] minCount  Never pop the chain below this many indices
+* @param[in] tolerance Turns with a smaller area count as straight
+*/
+static void hull2d_chainPop(const hull2d_t* hull, hull2d_chain_t* chain,
+    const flaggedindex_t* idx, int32_t minCount, double tolerance)
+{
+    const Point2f *p1, *p2, *p3;
+
+    p3 = &hull->points[idx->pointIdx];
+    while (hull2d_chain_count(chain) >= minCount + 2)
+    {
+        p1 = &hull->points[hull2d_chain_peek(chain, 1).pointIdx];
+        p2 = &hull->points[hull2d_chain_peek(chain, 0).pointIdx];
+
+        if (hull2d_areaSignTol(p1, p2, p3, tolerance) > 0)
+        {
+            break;
+        }
+        (void)hull2d_chain_pop(chain);
+    }
+}
+
+/**
+* @brief Akl-Toussaint heuristic, remove every index whose point lies strictly
+*        inside the polygon formed by the extreme points. Those points can
+*        never be on the hull boundary.
+* @param[in/out] hull Pointer to the hull object
+*/
+static void hull2d_cull(hull2d_t* hull)
+{
+    // extremes in CCW order starting from the lowest point:
+    // -y, +x-y, +x, +x+y, +y, -x+y, -x, -x-y
+    uint32_t extreme[8];
+    float    best[8];
+    float    value[8];
+    const Point2f* poly[8];
+    uint64_t left, right, keep;
+    uint32_t i, j, k, b, n, count, step, lowest;
+    const Point2f* p;
+
+    step = (hull->cull == HULL2D_CULL_QUAD) ? 2U : 1U;
+
+    lowest = hull->boundaryIdx[hull->lowestIdx].pointIdx;
+    for (k = 0; k < 8; ++k)
+    {
+        extreme[k] = lowest;
+        best[k] = -FLT_MAX;
+    }
+
+    // the extremes of every point are kept while points are only added,
+    // otherwise find them among the candidates, the lowest point is known
+    for (i = 0; i < hull->boundaryCount && !hull->extremesValid; ++i)
+    {
+        p = &hull->points[hull->boundaryIdx[i].pointIdx];
+        value[1] =  p->x - p->y;
+        value[2] =  p->x;
+        value[3] =  p->x + p->y;
+        value[4] =  p->y;
+        value[5] = -p->x + p->y;
+        value[6] = -p->x;
+        value[7] = -p->x - p->y;
+        for (k = step; k < 8; k += step)
+        {
+            if (value[k] > best[k])
+            {
+                best[k] = value[k];
+                extreme[k] = hull->boundaryIdx[i].pointIdx;
+            }
+        }
+    }
+
+    if (hull->extremesValid)
+    {
+        for (k = step; k < 8; k += step)
+        {
+            extreme[k] = hull->extremeIdx[k];
+        }
+    }
+
+    // build the culling polygon skipping repeated vertices
+    count = 0;
+    for (k = 0; k < 8; k += step)
+    {
+        p = &hull->points[extreme[k]];
+        if (count == 0 ||
+            (p != poly[count - 1] && p != poly[0]))
+        {
+            poly[count++] = p;
+        }
+    }
+
+    // polygon has no interior
+    if (count < 3)
+    {
+        return;
+    }
+
+    // keep everything not strictly inside the polygon, a block is tested
+    // against every edge before it is compacted
+    j = 0;
+    for (i = 0; i < hull->boundaryCount; i += n)
+    {
+        n = (hull->boundaryCount - i < HULL2D_SIGN_BLOCK) ?
+            hull->boundaryCount - i : HULL2D_SIGN_BLOCK;
+        keep = 0;
+        for (k = 0; k < count; ++k)
+        {
+            hull2d_areaSigns(hull->points, &hull->boundaryIdx[i], n,
+                poly[k], poly[(k + 1) % count], &left, &right);
+            keep |= ~left;
+        }
+        if (n < HULL2D_SIGN_BLOCK)
+        {
+            keep &= ((uint64_t)1 << n) - 1;
+        }
+
+        while (keep != 0)
+        {
+            b = i + hull2d_lowestBit(keep);
+            if (b == hull->lowestIdx)
+            {
+                hull->lowestIdx = j;
+            }
+            hull->boundaryIdx[j++] = hull->boundaryIdx[b];
+            keep &= keep - 1;
+        }
+    }
+    hull->boundaryCount = j;
+}
+
+/**
+* @brief Compute the hull using Graham's algorithm O(n log(n)). The scan runs
+*        in place in the boundary list, the scratch memory only holds the
+*        sort keys and the radix sort buffers.
+* @param[in/out] hull    Pointer to the hull object
+* @param[in/out] scratch HULL2D_SCRATCH_ITEMS items of scratch memory
+* @return Returns true if able to create a hull
+*/
+static bool_t hull2d_computeGrahams(hull2d_t* hull, flaggedindex_t* scratch)
+{
+    // the sort keys followed by both radix sort buffers
+    hull2d_sortkey_t* keys = (hull2d_sortkey_t*)scratch;
+    hull2d_radixpair_t* pairs =
+        (hull2d_radixpair_t*)&keys[MAX_POINTS_PER_HULL];
+
+    LOGASSERT(sizeof(hull2d_radixpair_t) == sizeof(hull2d_sortkey_t));
+
+    // Sort by angle from the lowest point (relative to +x vector)
+    hull2d_sort(hull, keys, pairs);
+
+    // Mark all but the farthest of each collinear run for removal
+    hull2d_flagCollinear(hull, keys);
+
+    // Run grahams algorithm over the points not marked for removal
+    hull2d_grahams(hull);
+
+    // verify there were enough points to build a hull
+    return (hull->boundaryCount >= 3);
+}
+
+/**
+* @brief Run Andrew's monotone chain over a range of indices already sorted by
+*        (x, y)
+* @param[in] hull      Pointer to the hull object
+* @param[in/out] scratch Scratch memory
+* @param[in] indices   First index of the range
+* @param[in] count     Number of indices in the range, must be at least one
+* @param[out] out      Receives the CCW boundary of the range starting at the
+*                      left-most point, may alias indices
+* @param[in] tolerance Turns with a smaller area count as straight
+* @return Number of indices written to out, less than 3 if the range has no
+*         interior
+*/
+static uint32_t hull2d_chainSorted(const hull2d_t* hull,
+    const hull2d_chain_t* scratch,
+    const flaggedindex_t* indices, uint32_t count, flaggedindex_t* out,
+    double tolerance)
+{
+    // the chain may briefly hold one index more than the range, it is built
+    // in the scratch memory because out may alias indices
+    hull2d_chain_t chain;
+    uint32_t i;
+    int32_t n, lowerCount;
+
+    LOGASSERT((uint32_t)scratch->maxItems >= count + 1);
+    hull2d_chain_view(&chain, scratch->data, scratch->maxItems);
+
+    // lower chain from left to right
+    for (i = 0; i < count; ++i)
+    {
+        hull2d_chainPop(hull, &chain, &indices[i], 0, tolerance);
+        (void)hull2d_chain_push(&chain, indices[i]);
+    }
+
+    // upper chain from right to left, the right-most point is already in the
+    // chain and the left-most point is where the lower chain started
+    lowerCount = hull2d_chain_count(&chain);
+    for (i = count - 1; i-- > 0;)
+    {
+        hull2d_chainPop(hull, &chain, &indices[i], lowerCount - 1,
+            tolerance);
+        if (i > 0)
+        {
+            (void)hull2d_chain_push(&chain, indices[i]);
+        }
+    }
+
+    n = hull2d_chain_count(&chain);
+    memcpy(out, chain.data, sizeof(flaggedindex_t) * (size_t)n);
+
+    return (uint32_t)n;
+}
+
+/**
+* @brief Run Andrew's monotone chain over a range of indices
+* @param[in/out] hull  Pointer to the hull object
+* @param[in/out] scratch Scratch memory
+* @param[in/out] indices First index of the range, sorted by (x, y) when done
+* @param[in] count     Number of indices in the range, must be at least one
+* @param[out] out      Receives the CCW boundary of the range starting at the
+*                      left-most point, may alias indices
+* @param[in] tolerance Turns with a smaller area count as straight
+* @return Number of indices written to out, less than 3 if the range has no
+*         interior
+*/
+static uint32_t hull2d_chainSlice(hull2d_t* hull,
+    const hull2d_chain_t* scratch,
+    flaggedindex_t* indices, uint32_t count, flaggedindex_t* out,
+    double tolerance)
+{
+    // Sort by x then y, no orientation tests needed
+    hull2d_sortXY(hull, indices, count);
+
+    return hull2d_chainSorted(hull, scratch, indices, count, out, tolerance);
+}
+
+/**
+* @brief Compute the hull using Andrew's monotone chain O(n log(n))
+* @param[in/out] hull  Pointer to the hull object
+* @param[in/out] scratch Scratch memory
+* @return Returns true if able to create a hull
+*/
+static bool_t hull2d_computeMonotone(hull2d_t* hull,
+    const hull2d_chain_t* scratch)
+{
+    hull->boundaryCount = hull2d_chainSlice(hull, scratch, hull->boundaryIdx,
+        hull->boundaryCount, hull->boundaryIdx, FLT_EPSILON);
+
+    // all points on the same line
+    if (hull->boundaryCount < 3)
+    {
+        hull2d_findLowest(hull);
+        return FALSE;
+    }
+
+    // Start the boundary at the lowest point like Graham's algorithm
+    hull2d_rotateToLowest(hull);
+
+    return TRUE;
+}
+
+/**
+* @brief Return true if c should replace b as the next boundary point after a,
+*        that is c is strictly right of ab or on ab and farther from a
+* @param[in] a Current boundary point
+* @param[in] b Current candidate
+* @param[in] c Point to test
+* @param[in] tolerance Turns with a smaller area count as straight
+*/
+static bool_t hull2d_beyond(const Point2f* a, const Point2f* b,
+    const Point2f* c, double tolerance)
+{
+    int32_t areaSign;
+    double db, dc;
+
+    areaSign = hull2d_areaSignTol(a, b, c, tolerance);
+    if (areaSign != 0)
+    {
+        return areaSign < 0;
+    }
+
+    db = (double)(b->x - a->x) * (double)(b->x - a->x) +
+         (double)(b->y - a->y) * (double)(b->y - a->y);
+    dc = (double)(c->x - a->x) * (double)(c->x - a->x) +
+         (double)(c->y - a->y) * (double)(c->y - a->y);
+    return dc > db;
+}
+
+/**
+* @brief Return true if b must leave a CCW chain a, b, c. That is abc turns
+*        right, or it is straight to within FLT_EPSILON and b lies on the way
+*        from a to c. A straight turn that goes back keeps b, it is the tip of
+*        a sliver and the most extreme point in its direction.
+* @param[in] a Previous point of the chain
+* @param[in] b Point to test
+* @param[in] c Next point of the chain
+*/
+static bool_t hull2d_straight(const Point2f* a, const Point2f* b,
+    const Point2f* c)
+{
+    int32_t areaSign = hull2d_areaSign(a, b, c);
+    return areaSign < 0 || (areaSign == 0 &&
+        ((double)b->x - a->x) * ((double)c->x - b->x) +
+        ((double)b->y - a->y) * ((double)c->y - b->y) > 0.0);
+}
+
+/**
+* @brief Drop the vertices of a convex ring that turn less than FLT_EPSILON,
+*        like the other engines do while they build the boundary
+* @param[in] hull     Pointer to the hull object
+* @param[in/out] ring First index of the CCW ring, ring[0] is always kept
+* @param[in] n        Number of indices in the ring
+* @return Number of indices left at the front of the ring
+*/
+static uint32_t hull2d_dropStraight(const hull2d_t* hull,
+    flaggedindex_t* ring, uint32_t n)
+{
+    uint32_t i, w;
+
+    w = (n > 0) ? 1 : 0;
+    for (i = 1; i < n; ++i)
+    {
+        while (w >= 2 && hull2d_straight(&hull->points[ring[w - 2].pointIdx],
+            &hull->points[ring[w - 1].pointIdx],
+            &hull->points[ring[i].pointIdx]))
+        {
+            w--;
+        }
+        ring[w++] = ring[i];
+    }
+
+    // the turn back into the first point
+    while (w >= 3 && hull2d_straight(&hull->points[ring[w - 2].pointIdx],
+        &hull->points[ring[w - 1].pointIdx],
+        &hull->points[ring[0].pointIdx]))
+    {
+        w--;
+    }
+
+    return w;
+}
+
+/**
+* @brief Compute the hull using Chan's algorithm O(n log(h)) where h is the
+*        number of points on the boundary.
+*
+*        Points are split into groups of m, each group is hulled with the
+*        monotone chain and then a Jarvis march wraps the group hulls for at
+*        most m steps. If the march does not close m is squared and the
+*        process repeats. Points that are not on their group hull can never be
+*        on the final boundary so they are discarded between rounds.
+*
+*        Instead of a binary search for the tangent of each group hull a
+*        pointer per group is advanced, as the march walks around the hull the
+*        tangent point only ever moves CCW around each group.
+* @param[in/out] hull  Pointer to the hull object
+* @param[in/out] scratch Scratch memory
+* @return Returns true if able to create a hull
+*/
+static bool_t hull2d_computeChans(hull2d_t* hull,
+    const hull2d_chain_t* scratch)
+{
+    uint32_t groupStart[HULL2D_CHAN_MAX_GROUPS + 1];
+    uint32_t tangent[HULL2D_CHAN_MAX_GROUPS];
+    uint32_t m, g, groupCount, start, size, w, i, k, next, step;
+    flaggedindex_t first, best;
+    hull2d_chain_t chain;
+    const flaggedindex_t* indices;
+    const Point2f *p, *q, *firstp, *bestp;
+    bool_t closed;
+
+    first = hull->boundaryIdx[hull->lowestIdx];
+    firstp = &hull->points[first.pointIdx];
+
+    m = HULL2D_CHAN_MIN_GROUP;
+    while (m < hull->boundaryCount)
+    {
+        // Hull every group and pack the group hulls to the front of the list
+        groupCount = 0;
+        w = 0;
+        for (start = 0; start < hull->boundaryCount; start += m)
+        {
+            size = hull->boundaryCount - start;
+            size = (size < m) ? size : m;
+            size = hull2d_chainSlice(hull, scratch, &hull->boundaryIdx[start],
+                size, &hull->boundaryIdx[w], HULL2D_EXACT);
+
+            groupStart[groupCount] = w;
+            tangent[groupCount] = hull2d_lowestOf(hull, &hull->boundaryIdx[w],
+                size);
+            groupCount++;
+            w += size;
+        }
+        groupStart[groupCount] = w;
+        hull->boundaryCount = w;
+
+        // Jarvis march over the group hulls for at most m steps, the group
+        // hulls fill the boundary list so the march goes to scratch memory
+        hull2d_chain_view(&chain, scratch->data, scratch->maxItems);
+        (void)hull2d_chain_push(&chain, first);
+        p = firstp;
+        closed = FALSE;
+        for (step = 0; step < m && !closed; ++step)
+        {
+            bestp = NULL;
+            for (g = 0; g < groupCount; ++g)
+            {
+                indices = &hull->boundaryIdx[groupStart[g]];
+                size = groupStart[g + 1] - groupStart[g];
+
+                // walk CCW to the tangent point seen from p. The group hulls
+                // are exact so the march is too, a tolerance would let the
+                // walk stop short of the tangent on a nearly flat run.
+                k = tangent[g];
+                for (i = 1; i < size; ++i)
+                {
+                    next = (k + 1 < size) ? k + 1 : 0;
+                    q = &hull->points[indices[k].pointIdx];
+                    if (!hull2d_beyond(p, q,
+                            &hull->points[indices[next].pointIdx],
+                            HULL2D_EXACT))
+                    {
+                        break;
+                    }
+                    k = next;
+                }
+                tangent[g] = k;
+
+                q = &hull->points[indices[k].pointIdx];
+                if (bestp == NULL ||
+                    hull2d_beyond(p, bestp, q, HULL2D_EXACT))
+                {
+                    bestp = q;
+                    best = indices[k];
+                }
+            }
+
+            if (bestp->x == firstp->x && bestp->y == firstp->y)
+            {
+                closed = TRUE;
+            }
+            else if (bestp->x == p->x && bestp->y == p->y)
+            {
+                // every point is colocated
+                break;
+            }
+            else
+            {
+                (void)hull2d_chain_push(&chain, best);
+                p = bestp;
+            }
+        }
+
+        if (closed)
+        {
+            size = hull2d_dropStraight(hull, chain.data,
+                (uint32_t)hull2d_chain_count(&chain));
+
+            // all points on the same line
+            if (size < 3)
+            {
+                hull2d_findLowest(hull);
+                return FALSE;
+            }
+
+            // Copy the march back to hull indices, first is the lowest
+            hull->boundaryCount = size;
+            memcpy(hull->boundaryIdx, chain.data,
+                sizeof(flaggedindex_t) * hull->boundaryCount);
+            hull->lowestIdx = 0;
+            return TRUE;
+        }
+
+        // Hull has more than m points, square the group size and try again
+        m = m * m;
+    }
+
+    // A single group, the group hull is the answer
+    return hull2d_computeMonotone(hull, scratch);
+}
+
+/**
+* @brief Swap two hull indices
+* @param[in/out] a First index
+* @param[in/out] b Second index
+*/
+static void hull2d_swap(flaggedindex_t* a, flaggedindex_t* b)
+{
+    flaggedindex_t temp;
+    temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/**
+* @brief Recursive step of QuickHull. Every index in the range is strictly
+*        right of ab, the range is partitioned in place around the point
+*        farthest from ab and points inside the triangle are dropped.
+* @param[in] hull Pointer to the hull object
+* @param[in/out] indices First index of the range, receives the boundary
+*                between a and b (exclusive) in CCW order when done
+* @param[in] count Number of indices in the range
+* @param[in] a Start of the outer edge
+* @param[in] b End of the outer edge
+* @return Number of boundary indices written to the front of the range
+*/
+static uint32_t hull2d_quickChain(const hull2d_t* hull,
+    flaggedindex_t* indices, uint32_t count, const Point2f* a,
+    const Point2f* b)
+{
+    uint32_t i, n1, n2, c1, c2, far;
+    double area2, along, farArea2, farAlong;
+    flaggedindex_t fidx;
+    const Point2f *f, *p;
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // find the point farthest from ab and move it to the front, if several
+    // are equally far take the one nearest a so the rest are not collinear
+    // with both of the new edges
+    far = 0;
+    farArea2 = 0.0;
+    farAlong = 0.0;
+    for (i = 0; i < count; ++i)
+    {
+        p = &hull->points[indices[i].pointIdx];
+        area2 = ((double)p->x - a->x) * ((double)b->y - a->y) -
+                ((double)b->x - a->x) * ((double)p->y - a->y);
+        along = ((double)p->x - a->x) * ((double)b->x - a->x) +
+                ((double)p->y - a->y) * ((double)b->y - a->y);
+        if (area2 > farArea2 || (area2 == farArea2 && along < farAlong))
+        {
+            farArea2 = area2;
+            farAlong = along;
+            far = i;
+        }
+    }
+    hull2d_swap(&indices[0], &indices[far]);
+    f = &hull->points[indices[0].pointIdx];
+
+    // points outside af follow f, then points outside fb, drop the rest
+    n1 = 1 + hull2d_partitionRight(hull, a, f, &indices[1], count - 1);
+    n2 = n1 + hull2d_partitionRight(hull, f, b, &indices[n1], count - n1);
+
+    c1 = hull2d_quickChain(hull, &indices[1], n1 - 1, a, f);
+    c2 = hull2d_quickChain(hull, &indices[n1], n2 - n1, f, b);
+
+    // pack the chains as [a..f) f [f..b)
+    fidx = indices[0];
+    memmove(&indices[0], &indices[1], sizeof(flaggedindex_t) * c1);
+    indices[c1] = fidx;
+    memmove(&indices[c1 + 1], &indices[n1], sizeof(flaggedindex_t) * c2);
+
+    return c1 + 1 + c2;
+}
+
+/**
+* @brief Compute the hull using QuickHull, expected O(n log(n)) and close to
+*        linear when most points are interior. Works in place on boundaryIdx
+*        and needs no scratch space.
+* @param[in/out] hull Pointer to the hull object
+* @return Returns true if able to create a hull
+*/
+static bool_t hull2d_computeQuick(hull2d_t* hull)
+{
+    uint32_t i, n, left, right, nLower, nUpper, cLower, cUpper;
+    flaggedindex_t* indices;
+    flaggedindex_t bidx;
+    const Point2f *a, *b, *p;
+
+    indices = hull->boundaryIdx;
+    n = hull->boundaryCount;
+
+    // left-most (lowest if same) and right-most (highest if same) points
+    left = 0;
+    right = 0;
+    for (i = 1; i < n; ++i)
+    {
+        p = &hull->points[indices[i].pointIdx];
+        a = &hull->points[indices[left].pointIdx];
+        b = &hull->points[indices[right].pointIdx];
+        if (p->x < a->x || (p->x == a->x && p->y < a->y))
+        {
+            left = i;
+        }
+        if (p->x > b->x || (p->x == b->x && p->y > b->y))
+        {
+            right = i;
+        }
+    }
+
+    // move the left-most point to the front and the right-most to the back
+    hull2d_swap(&indices[0], &indices[left]);
+    if (right == 0)
+    {
+        right = left;
+    }
+    hull2d_swap(&indices[n - 1], &indices[right]);
+    a = &hull->points[indices[0].pointIdx];
+    b = &hull->points[indices[n - 1].pointIdx];
+
+    // points below ab, then points above ab, drop the rest
+    nLower = 1 + hull2d_partitionRight(hull, a, b, &indices[1], n - 2);
+    nUpper = nLower + hull2d_partitionRight(hull, b, a, &indices[nLower],
+        n - 1 - nLower);
+
+    cLower = hull2d_quickChain(hull, &indices[1], nLower - 1, a, b);
+    cUpper = hull2d_quickChain(hull, &indices[nLower], nUpper - nLower, b, a);
+
+    // pack the boundary as a [lower chain] b [upper chain]
+    bidx = indices[n - 1];
+    memmove(&indices[cLower + 2], &indices[nLower],
+        sizeof(flaggedindex_t) * cUpper);
+    indices[cLower + 1] = bidx;
+    hull->boundaryCount = cLower + cUpper + 2;
+
+    // all points on the same line
+    if (hull->boundaryCount < 3)
+    {
+        hull2d_findLowest(hull);
+        return FALSE;
+    }
+
+    // Start the boundary at the lowest point like Graham's algorithm
+    hull2d_rotateToLowest(hull);
+
+    return TRUE;
+}
+
+/**
+* @brief Get a point on the boundary
+* @param[in] hull Pointer to the hull object
+* @param[in] k Location in the boundary list
+*/
+static const Point2f* hull2d_vertex(const hull2d_t* hull, uint32_t k)
+{
+    return &hull->points[hull->boundaryIdx[k].pointIdx];
+}
+
+/**
+* @brief Return true if the vertex of edge ab that q is connected past must
+*        leave the boundary, that is q sees ab or abq is straight. The tests
+*        of an insertion are exact, the boundary is strictly convex under the
+*        exact orientation. With a tolerance a point next to a short edge can
+*        look outside one edge and on the line of the next at the same time.
+* @param[in] a Start of the edge
+* @param[in] b End of the edge
+* @param[in] q Point being inserted
+*/
+static bool_t hull2d_hides(const Point2f* a, const Point2f* b,
+    const Point2f* q)
+{
+    return hull2d_areaSignTol(a, b, q, HULL2D_EXACT) <= 0;
+}
+
+/**
+* @brief Return true if q projects onto the line through ab before a
+* @param[in] a Start of the edge
+* @param[in] b End of the edge
+* @param[in] q Point to test
+*/
+static bool_t hull2d_before(const Point2f* a, const Point2f* b,
+    const Point2f* q)
+{
+    return ((double)q->x - a->x) * ((double)b->x - a->x) +
+           ((double)q->y - a->y) * ((double)b->y - a->y) < 0.0;
+}
+
+/**
+* @brief Find an edge of a computed hull that sees point q in O(log(h)). The
+*        boundary starts at the lowest point p0 and the other vertices are in
+*        angular order about it so a binary search finds the wedge holding q.
+* @param[in] hull Pointer to a computed hull
+* @param[in] q    Point to test
+* @param[out] edge Location of the start of an edge that sees q
+* @return Returns false if q is inside or on the hull
+*/
+static bool_t hull2d_findVisibleEdge(const hull2d_t* hull, const Point2f* q,
+    uint32_t* edge)
+{
+    uint32_t lo, hi, mid, h;
+    int32_t sign;
+    const Point2f *p0, *a, *b;
+
+    h = hull->boundaryCount;
+    p0 = hull2d_vertex(hull, 0);
+
+    // outside the wedge at p0, one of the edges at p0 sees q
+    if (hull2d_areaSignTol(p0, hull2d_vertex(hull, 1), q, HULL2D_EXACT) < 0)
+    {
+        *edge = 0;
+        return TRUE;
+    }
+    if (hull2d_areaSignTol(hull2d_vertex(hull, h - 1), p0, q,
+        HULL2D_EXACT) < 0)
+    {
+        *edge = h - 1;
+        return TRUE;
+    }
+
+    // q is left of p0 -> v[lo] and right of p0 -> v[hi]
+    lo = 1;
+    hi = h - 1;
+    while (hi - lo > 1)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (hull2d_areaSignTol(p0, hull2d_vertex(hull, mid), q,
+            HULL2D_EXACT) >= 0)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    *edge = lo;
+    a = hull2d_vertex(hull, lo);
+    b = hull2d_vertex(hull, hi);
+    sign = hull2d_areaSignTol(a, b, q, HULL2D_EXACT);
+    if (sign != 0)
+    {
+        return sign < 0;
+    }
+
+    // on the line through the edge q is outside if it is past either end,
+    // then it replaces that end
+    return hull2d_before(a, b, q) || hull2d_before(b, a, q);
+}
+
+/**
+* @brief Add a point to a computed hull. Points inside the hull are dropped
+*        after an O(log(h)) test, otherwise the boundary between the two
+*        tangent points of q is replaced by q. The boundary is rotated back to
+*        the lowest point and the vertex arrays are rewritten, so an insertion
+*        costs O(h).
+* @param[in/out] hull Pointer to a computed hull
+* @param[in] qidx     Index of the point to insert
+*/
+static void hull2d_insertPoint(hull2d_t* hull, const flaggedindex_t* qidx)
+{
+    uint32_t h, s, e, prev, next, removed, kept;
+    const Point2f* q;
+
+    h = hull->boundaryCount;
+    q = &hull->points[qidx->pointIdx];
+
+    if (!hull2d_findVisibleEdge(hull, q, &s))
+    {
+        return;
+    }
+
+    // widen the visible edge s -> e in both directions, only the vertices
+    // strictly between s and e are removed so at least two stay
+    e = (s + 1 < h) ? s + 1 : 0;
+    removed = 0;
+    while (removed + 3 <= h)
+    {
+        prev = (s > 0) ? s - 1 : h - 1;
+        if (!hull2d_hides(hull2d_vertex(hull, prev),
+            hull2d_vertex(hull, s), q))
+        {
+            break;
+        }
+        s = prev;
+        removed++;
+    }
+    while (removed + 3 <= h)
+    {
+        next = (e + 1 < h) ? e + 1 : 0;
+        if (!hull2d_hides(hull2d_vertex(hull, e),
+            hull2d_vertex(hull, next), q))
+        {
+            break;
+        }
+        e = next;
+        removed++;
+    }
+
+    // the kept chain runs from e around to s, put it first and append q
+    kept = h - removed;
+    hull2d_rotate(hull, e);
+    hull->boundaryIdx[kept] = *qidx;
+    hull->boundaryCount = kept + 1;
+
+    hull2d_rotateToLowest(hull);
+    hull2d_storeVertices(hull);
+}
+
+/**
+* @brief Return true if a point of a sign block lies past the end a of an edge
+*        ab, that is before a on the way from a to b
+* @param[in] hull Pointer to the hull object
+* @param[in] first Index of the first point of the block
+* @param[in] mask Bit i set if point first + i is to be tested
+* @param[in] a The end of the edge
+* @param[in] b The other end of the edge
+* @param[in] skip Index of a point that is never past a
+*/
+static bool_t hull2d_pastEnd(const hull2d_t* hull, uint32_t first,
+    uint64_t mask, const Point2f* a, const Point2f* b, uint32_t skip)
+{
+    uint32_t j;
+
+    while (mask != 0)
+    {
+        j = first + hull2d_lowestBit(mask);
+        if (j != skip && hull2d_before(a, b, &hull->points[j]))
+        {
+            return TRUE;
+        }
+        mask &= mask - 1;
+    }
+
+    return FALSE;
+}
+
+/**
+* @brief Remove a vertex from a computed hull. Only points strictly inside the
+*        pocket between the neighbours u and w of the vertex can replace it,
+*        those are gathered in place of the vertex and QuickHull builds the
+*        new chain from u to w. Every point is scanned, so a removal is O(n).
+* @param[in/out] hull Pointer to a computed hull
+* @param[in] k Location of the vertex in the boundary list
+* @return Returns false if the remaining points have no interior or the
+*         pocket can't be repaired without moving u or w, rebuild the hull
+*/
+static bool_t hull2d_removeVertex(hull2d_t* hull, uint32_t k)
+{
+    uint64_t left, right, leftT, leftX, right2, valid;
+    uint32_t i, j, n, h, count, vidx;
+    flaggedindex_t* pocket;
+    const Point2f *t, *u, *w, *x;
+
+    h = hull->boundaryCount;
+    vidx = hull->boundaryIdx[k].pointIdx;
+
+    // put the vertex last so the boundary runs w, x ... t, u
+    hull2d_rotate(hull, (k + 1 < h) ? k + 1 : 0);
+    w = hull2d_vertex(hull, 0);
+    x = hull2d_vertex(hull, 1);
+    t = hull2d_vertex(hull, h - 3);
+    u = hull2d_vertex(hull, h - 2);
+
+    // gather every point past uw over the vertex and the free space after it
+    pocket = &hull->boundaryIdx[h - 1];
+    count = 0;
+    for (i = 0; i < hull->pointCount; i += n)
+    {
+        n = (hull->pointCount - i < HULL2D_SIGN_BLOCK) ?
+            hull->pointCount - i : HULL2D_SIGN_BLOCK;
+        valid = (n < HULL2D_SIGN_BLOCK) ?
+            ((uint64_t)1 << n) - 1 : ~(uint64_t)0;
+        hull2d_areaSigns(&hull->points[i], NULL, n, u, w, &left, &right);
+        hull2d_areaSigns(&hull->points[i], NULL, n, t, u, &leftT, &right2);
+        hull2d_areaSigns(&hull->points[i], NULL, n, w, x, &leftX, &right2);
+
+        // The vertex covered points within the tolerance of uw, tu or wx that
+        // lie past u or w. Those push u or w inside once the vertex is gone,
+        // which the pocket can't repair.
+        if (hull2d_pastEnd(hull, i, ~left & valid, u, w, vidx) ||
+            hull2d_pastEnd(hull, i, ~left & valid, w, u, vidx) ||
+            hull2d_pastEnd(hull, i, ~leftT & valid, u, t, vidx) ||
+            hull2d_pastEnd(hull, i, ~leftX & valid, w, x, vidx))
+        {
+            return FALSE;
+        }
+
+        while (right != 0)
+        {
+            j = i + hull2d_lowestBit(right);
+            if (j != vidx)
+            {
+                pocket[count].pointIdx = j;
+                pocket[count].remove = FALSE;
+                count++;
+            }
+            right &= right - 1;
+        }
+    }
+
+    hull->boundaryCount = h - 1 +
+        hull2d_quickChain(hull, pocket, count, u, w);
+
+    if (hull->boundaryCount < 3)
+    {
+        return FALSE;
+    }
+
+    hull2d_rotateToLowest(hull);
+    hull2d_storeVertices(hull);
+    return TRUE;
+}
+
+/**
+* @brief Compute the hull using the points in the hull's point list
+* @param[in/out] hull Pointer to the hull object
+* @param[in/out] context A context initialized by hull2d_initContext
+* @return Returns true if able to create a hull false otherwise, only fails if
+*         two or less points are in the hull or all points fall on same line.
+*/
+bool_t hull2d_computeHull(hull2d_t* hull, hull2d_context_t* context)
+{
+    // nothing to do
+    if (hull->dirty == FALSE)
+    {
+        return TRUE;
+    }
+
+    // verify there are enough points to build a hull
+    if (hull->boundaryCount < 3)
+    {
+        return FALSE;
+    }
+
+    // Discard interior points before the O(n log(n)) sort
+    if (hull->cull != HULL2D_CULL_NONE)
+    {
+        hull2d_cull(hull);
+    }
+
+    return hull2d_runEngine(hull, &context->scratch);
+}
+
+/**
+* @brief Run the selected engine over the boundary list
+* @param[in/out] hull  Pointer to the hull object, with at least 3 points
+* @param[in/out] scratch Scratch memory
+* @return Returns true if able to create a hull
+*/
+static bool_t hull2d_runEngine(hull2d_t* hull, hull2d_chain_t* scratch)
+{
+    bool_t success;
+
+    switch (hull->engine)
+    {
+    case HULL2D_ENGINE_MONOTONE:
+        success = hull2d_computeMonotone(hull, scratch);
+        break;
+    case HULL2D_ENGINE_CHAN:
+        success = hull2d_computeChans(hull, scratch);
+        break;
+    case HULL2D_ENGINE_QUICKHULL:
+        success = hull2d_computeQuick(hull);
+        break;
+    case HULL2D_ENGINE_GRAHAM:
+    default:
+        success = hull2d_computeGrahams(hull, scratch->data);
+        break;
+    }
+
+    if (success)
+    {
+        hull2d_storeVertices(hull);
+        hull2d_findExtremes(hull);
+        hull->dirty = FALSE;
+    }
+
+    return success;
+}
+
+/**
+* @brief Check if two line segments (a0, a1) and (b0, b1) intersect
+* @param[in] a0 An endpoint of the first line segement
+* @param[in] a1 An endpoint of the first line segement
+* @param[in] b0 An endpoint of the second line segement
+* @param[in] b1 An endpoint of the second line segement
+* @return Returns TRUE if the segements intersect, FALSE otherwise
+*/
+bool_t hull2d_segSegIntersect(const Point2f* a0, const Point2f* a1,
+    const Point2f* b0, const Point2f* b1)
+{
+    double s, t;
+    double num, denom;
+
+    denom = (double)a0->x * (double)( b1->y - b0->y ) +
+            (double)a1->x * (double)( b0->y - b1->y ) +
+            (double)b1->x * (double)( a1->y - a0->y ) +
+            (double)b0->x * (double)( a0->y - a1->y );
+
+    // check if segements are parallel (don't intersect)
+    if (fabs(denom) < FLT_EPSILON)
+    {
+        return FALSE;
+    }
+
+    num = (double)a0->x * (double)( b1->y - b0->y ) +
+          (double)b0->x * (double)( a0->y - b1->y ) +
+          (double)b1->x * (double)( b0->y - a0->y );
+    s = num / denom;
+
+    num = -( (double)a0->x * (double)( b0->y - a1->y ) +
+             (double)a1->x * (double)( a0->y - b0->y ) +
+             (double)b0->x * (double)( a1->y - a0->y ) );
+    t = num / denom;
+    
+    // intersection point is
+    // x = a0->x + s * (a1->x - a0->x)
+    // y = a0->y + t * (a1->y - a0->y)
+
+    // Intersects if s and t are both between 0 and 1
+    return ( (0.0 <= s) && (s <= 1.0) && (0.0 <= t) && (t <= 1.0) );
+}
+
+/**
+* @brief Copy the boundary of a computed hull into its vertex arrays and
+*        update its bounding box and bounding circle
+* @param[in/out] hull Pointer to the hull object
+*/
+static void hull2d_storeVertices(hull2d_t* hull)
+{
+    const Point2f* p;
+    uint32_t i;
+    float dx, dy, distSq, maxDistSq;
+
+    hull->minX = FLT_MAX;
+    hull->minY = FLT_MAX;
+    hull->maxX = -FLT_MAX;
+    hull->maxY = -FLT_MAX;
+    for (i = 0; i < hull->boundaryCount; ++i)
+    {
+        p = &hull->points[hull->boundaryIdx[i].pointIdx];
+        hull->vertexX[i] = p->x;
+        hull->vertexY[i] = p->y;
+        hull->minX = (p->x < hull->minX) ? p->x : hull->minX;
+        hull->minY = (p->y < hull->minY) ? p->y : hull->minY;
+        hull->maxX = (p->x > hull->maxX) ? p->x : hull->maxX;
+        hull->maxY = (p->y > hull->maxY) ? p->y : hull->maxY;
+    }
+
+    // repeat the first vertex so edge i always ends at vertex i + 1
+    hull->vertexX[i] = hull->vertexX[0];
+    hull->vertexY[i] = hull->vertexY[0];
+
+    // circle around the box center, not the smallest one but close enough to
+    // reject pairs the box test lets through along the diagonals
+    hull->centerX = 0.5f * (hull->minX + hull->maxX);
+    hull->centerY = 0.5f * (hull->minY + hull->maxY);
+    maxDistSq = 0.0f;
+    for (i = 0; i < hull->boundaryCount; ++i)
+    {
+        dx = hull->vertexX[i] - hull->centerX;
+        dy = hull->vertexY[i] - hull->centerY;
+        distSq = dx * dx + dy * dy;
+        maxDistSq = (distSq > maxDistSq) ? distSq : maxDistSq;
+    }
+
+    // grow the radius by a few ulps so rounding never rejects touching hulls
+    hull->radius = sqrtf(maxDistSq);
+    hull->radius += hull->radius * (4.0f * FLT_EPSILON);
+}
+
+/**
+* @brief Get a vertex of a computed hull from its vertex arrays
+* @param[in] hull Pointer to the hull object
+* @param[in] k    Index of the vertex, at most boundaryCount
+* @return Returns the vertex
+*/
+static Point2f hull2d_vertexAt(const hull2d_t* hull, uint32_t k)
+{
+    Point2f p;
+    p.x = hull->vertexX[k];
+    p.y = hull->vertexY[k];
+    return p;
+}
+
+/**
+* @brief Find the edges of a computed hull that a point is strictly right of,
+*        one edge at a time
+* @param[in] hull  Pointer to a computed hull
+* @param[in] first First edge to test, edge k runs from vertex k to k + 1
+* @param[in] count Number of edges to test, at most HULL2D_SIGN_BLOCK
+* @param[in] p     Point to test
+* @return Bit i is set if p is strictly right of edge first + i
+*/
+static uint64_t hull2d_edgesRightScalar(const hull2d_t* hull, uint32_t first,
+    uint32_t count, const Point2f* p)
+{
+    uint64_t right;
+    uint32_t i;
+    Point2f a, b;
+
+    right = 0;
+    for (i = 0; i < count; ++i)
+    {
+        a = hull2d_vertexAt(hull, first + i);
+        b = hull2d_vertexAt(hull, first + i + 1);
+        right |= (uint64_t)(hull2d_areaSign(&a, &b, p) < 0) << i;
+    }
+    return right;
+}
+
+#ifdef HULL2D_AVX2
+
+/**
+* @brief Same as hull2d_edgesRightScalar 4 edges per iteration, straight from
+*        the vertex arrays. The area is computed in double in the same order
+*        as hull2d_areaSign so the signs match it exactly.
+* @param[in] hull  Pointer to a computed hull
+* @param[in] first First edge to test, edge k runs from vertex k to k + 1
+* @param[in] count Number of edges to test, at most HULL2D_SIGN_BLOCK
+* @param[in] p     Point to test
+* @return Bit i is set if p is strictly right of edge first + i
+*/
+HULL2D_TARGET_AVX2
+static uint64_t hull2d_edgesRightAvx2(const hull2d_t* hull, uint32_t first,
+    uint32_t count, const Point2f* p)
+{
+    __m256d px, py, x0, y0, ex, ey, neps, area2;
+    const float* vx = &hull->vertexX[first];
+    const float* vy = &hull->vertexY[first];
+    uint64_t right;
+    uint32_t i;
+
+    px = _mm256_set1_pd(p->x);
+    py = _mm256_set1_pd(p->y);
+    neps = _mm256_set1_pd(-FLT_EPSILON);
+
+    right = 0;
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        // the vertex arrays repeat the first vertex, so i + 4 is in range
+        x0 = _mm256_cvtps_pd(_mm_loadu_ps(&vx[i]));
+        y0 = _mm256_cvtps_pd(_mm_loadu_ps(&vy[i]));
+        ex = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(&vx[i + 1])), x0);
+        ey = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(&vy[i + 1])), y0);
+
+        area2 = _mm256_sub_pd(
+            _mm256_mul_pd(ex, _mm256_sub_pd(py, y0)),
+            _mm256_mul_pd(_mm256_sub_pd(px, x0), ey));
+        right |= (uint64_t)_mm256_movemask_pd(
+            _mm256_cmp_pd(area2, neps, _CMP_LT_OQ)) << i;
+    }
+
+    // fewer than 4 edges left
+    if (i < count)
+    {
+        right |= hull2d_edgesRightScalar(hull, first + i, count - i, p) << i;
+    }
+
+    return right;
+}
+
+#endif
+
+/**
+* @brief Find the edges of a computed hull that a point is strictly right of,
+*        using AVX2 when the processor supports it
+* @param[in] hull  Pointer to a computed hull
+* @param[in] first First edge to test, edge k runs from vertex k to k + 1
+* @param[in] count Number of edges to test, at most HULL2D_SIGN_BLOCK
+* @param[in] p     Point to test
+* @return Bit i is set if p is strictly right of edge first + i
+*/
+static uint64_t hull2d_edgesRight(const hull2d_t* hull, uint32_t first,
+    uint32_t count, const Point2f* p)
+{
+#ifdef HULL2D_AVX2
+    if (hull2d_useAvx2())
+    {
+        return hull2d_edgesRightAvx2(hull, first, count, p);
+    }
+#endif
+    return hull2d_edgesRightScalar(hull, first, count, p);
+}
+
+/**
+* @brief Check if a point is inside a convex hull
+* @param[in] hull Pointer to the hull
+* @param[in] p    Pointer to the point
+* @return Returns TRUE if the point is inside the hull, FALSE otherwise
+*/
+bool_t hull2d_pointInHull(const hull2d_t* hull, const Point2f* p)
+{
+    // Point must be to left of all segements, a block of edges at a time
+    uint32_t i, n;
+
+    for (i = 0; i < hull->boundaryCount; i += n)
+    {
+        n = (hull->boundaryCount - i < HULL2D_SIGN_BLOCK) ?
+            hull->boundaryCount - i : HULL2D_SIGN_BLOCK;
+        if (hull2d_edgesRight(hull, i, n, p) != 0)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+* @brief Find where a segment first enters a convex hull, clipping the segment
+*        against the half plane of every edge (Cyrus-Beck)
+* @param[in] hull      Pointer to the hull
+* @param[in] from      Start of the segment
+* @param[in] to        End of the segment
+* @param[out] fraction Receives the position of the first hit along the
+*                      segment, 0 if from is inside
+* @return Returns TRUE if the segment hits the hull, FALSE otherwise
+*/
+bool_t hull2d_raycast(const hull2d_t* hull, const Point2f* from,
+    const Point2f* to, float* fraction)
+{
+    uint32_t i;
+    float dx, dy, nx, ny, num, den, t;
+    float enter = 0.0f;
+    float exit = 1.0f;
+
+    LOGASSERT(!hull->dirty);
+
+    if (hull->boundaryCount < 3)
+    {
+        return FALSE;
+    }
+
+    dx = to->x - from->x;
+    dy = to->y - from->y;
+    for (i = 0; i < hull->boundaryCount; ++i)
+    {
+        // outward normal of the counter clockwise edge i
+        nx = hull->vertexY[i + 1] - hull->vertexY[i];
+        ny = hull->vertexX[i] - hull->vertexX[i + 1];
+
+        // the segment is inside the edge where t * den <= num
+        num = nx * (hull->vertexX[i] - from->x) +
+              ny * (hull->vertexY[i] - from->y);
+        den = nx * dx + ny * dy;
+
+        if (den == 0.0f)
+        {
+            // parallel to the edge, entirely inside or outside of it
+            if (num < 0.0f)
+            {
+                return FALSE;
+            }
+            continue;
+        }
+
+        t = num / den;
+        if (den < 0.0f)
+        {
+            enter = (t > enter) ? t : enter;
+        }
+        else
+        {
+            exit = (t < exit) ? t : exit;
+        }
+
+        if (enter > exit)
+        {
+            return FALSE;
+        }
+    }
+
+    *fraction = enter;
+    return TRUE;
+}
+
+/**
+* @brief Check if two convex hulls intersect
+* @param[in] h1 The first hull
+* @param[in] h2 The second hull
+* @return True if h1 intesects h2, false otherwise
+*/
+bool_t hull2d_checkIntersect(const hull2d_t* ha, const hull2d_t* hb)
+{
+    uint32_t idxA, idxB;
+    uint32_t aMax, bMax;
+    float crossMag;
+    float dx, dy, radii;
+    bool_t aLeftB;
+    bool_t bLeftA;
+
+    Point2f a0, a1;
+    Point2f b0, b1;
+
+    // assert that hulls have been caluculated
+    LOGASSERT(!ha->dirty && !hb->dirty);
+
+    // most pairs are far apart, reject them on the bounding box and circle
+    if (ha->minX > hb->maxX || hb->minX > ha->maxX ||
+        ha->minY > hb->maxY || hb->minY > ha->maxY)
+    {
+        return FALSE;
+    }
+
+    dx = hb->centerX - ha->centerX;
+    dy = hb->centerY - ha->centerY;
+    radii = ha->radius + hb->radius;
+    if (dx * dx + dy * dy > radii * radii)
+    {
+        return FALSE;
+    }
+
+    aMax = ha->boundaryCount;
+    bMax = hb->boundaryCount;
+
+    // edge i runs from vertex i to vertex i + 1, the first vertex is repeated
+    // at the end so no index wraps around
+    idxA = 0;
+    idxB = 0;
+    do
+    {
+        a0 = hull2d_vertexAt(ha, idxA);
+        a1 = hull2d_vertexAt(ha, idxA + 1);
+        b0 = hull2d_vertexAt(hb, idxB);
+        b1 = hull2d_vertexAt(hb, idxB + 1);
+
+        // test for two line segements intersecting
+        if (hull2d_segSegIntersect(&a0, &a1, &b0, &b1))
+        {
+            return TRUE;
+        }
+
+        crossMag = (a1.x - a0.x) * (b1.y - b0.y) -
+                   (a1.y - a0.y) * (b1.x - b0.x);
+
+        aLeftB = hull2d_left(&b0, &b1, &a1);
+        bLeftA = hull2d_left(&a0, &a1, &b1);
+
+        // advance pointers
+        if (crossMag < -FLT_EPSILON)
+        {
+            if ( aLeftB )
+            {
+                idxB++;
+            }
+            else
+            {
+                idxA++;
+            }
+        }
+        else
+        {
+            if ( bLeftA )
+            {
+                idxA++;
+            }
+            else
+            {
+                idxB++;
+            }
+        }
+    } while (idxA < aMax && idxB < bMax);
+    // If we got here then no edges intersect
+
+    // Check for case A subset of B
+    a0 = hull2d_vertexAt(ha, 0);
+    b0 = hull2d_vertexAt(hb, 0);
+    if (hull2d_pointInHull(hb, &a0))
+    {
+        return TRUE;
+    }
+    // Check for case B subset of A
+    else if (hull2d_pointInHull(ha, &b0))
+    {
+        return TRUE;
+    }
+
+    // otherwise they don't intersect
+    return FALSE;
+}
+
+/**
+* @brief Check if edge direction a turns less than b, both measured counter
+*        clockwise from the reference direction r in [0, 2 pi)
+* @param[in] rx, ry Reference direction
+* @param[in] ax, ay First direction
+* @param[in] bx, by Second direction
+* @return Returns true if a comes before b
+*/
+static bool_t hull2d_turnsBefore(float rx, float ry, float ax, float ay,
+    float bx, float by)
+{
+    // directions in the half turn past the reference come second
+    float ca = rx * ay - ry * ax;
+    float cb = rx * by - ry * bx;
+    bool_t halfA = (ca < 0.0f) || (ca == 0.0f && rx * ax + ry * ay < 0.0f);
+    bool_t halfB = (cb < 0.0f) || (cb == 0.0f && rx * bx + ry * by < 0.0f);
+
+    if (halfA != halfB)
+    {
+        return halfB;
+    }
+    return (ax * by - ay * bx) > 0.0f;
+}
+
+/**
+* @brief Find the boundary vertex of a computed hull furthest along a
+*        direction. Going round a convex boundary the edges turn one way, the
+*        furthest vertex starts the first edge turned past the direction
+*        rotated a quarter turn, so it is binary searched on the turn of the
+*        edges from the first edge.
+* @param[in] hull Pointer to the hull object
+* @param[in] dx   Direction along x
+* @param[in] dy   Direction along y
+* @return Returns the index of the vertex in the vertex arrays
+*/
+static uint32_t hull2d_support(const hull2d_t* hull, float dx, float dy)
+{
+    const float* vx = hull->vertexX;
+    const float* vy = hull->vertexY;
+    uint32_t n = hull->boundaryCount;
+    uint32_t i, lo, hi, mid, best;
+    float rx, ry, dot, bestDot;
+
+    rx = vx[1] - vx[0];
+    ry = vy[1] - vy[0];
+    if (n > HULL2D_SUPPORT_SCAN && (rx != 0.0f || ry != 0.0f))
+    {
+        lo = 0;
+        hi = n;
+        while (lo < hi)
+        {
+            mid = lo + (hi - lo) / 2;
+            if (hull2d_turnsBefore(rx, ry, vx[mid + 1] - vx[mid],
+                vy[mid + 1] - vy[mid], -dy, dx))
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        best = (lo < n) ? lo : 0;
+
+        // rounding can leave the search a vertex off, a local maximum of a
+        // convex boundary is the maximum so climb to it
+        bestDot = vx[best] * dx + vy[best] * dy;
+        for (;;)
+        {
+            i = (best + 1 < n) ? best + 1 : 0;
+            dot = vx[i] * dx + vy[i] * dy;
+            if (dot <= bestDot)
+            {
+                i = (best > 0) ? best - 1 : n - 1;
+                dot = vx[i] * dx + vy[i] * dy;
+                if (dot <= bestDot)
+                {
+                    break;
+                }
+            }
+            best = i;
+            bestDot = dot;
+        }
+        return best;
+    }
+
+    best = 0;
+    bestDot = vx[0] * dx + vy[0] * dy;
+    for (i = 1; i < n; ++i)
+    {
+        dot = vx[i] * dx + vy[i] * dy;
+        if (dot > bestDot)
+        {
+            best = i;
+            bestDot = dot;
+        }
+    }
+    return best;
+}
+
+/**
+* @brief Copy vertex k of a simplex over vertex j
+* @param[in/out] s Pointer to the simplex
+* @param[in] j     Vertex replaced
+* @param[in] k     Vertex kept
+*/
+static void hull2d_simplexMove(hull2d_simplex_t* s, uint32_t j, uint32_t k)
+{
+    s->w[j] = s->w[k];
+    s->idxA[j] = s->idxA[k];
+    s->idxB[j] = s->idxB[k];
+}
+
+/**
+* @brief Find the point of a simplex closest to the origin and drop the
+*        vertices not needed to express it
+* @param[in/out] s Pointer to the simplex, its count is 3 afterwards only if
+*                  the triangle holds the origin
+* @return Returns the closest point
+*/
+static Point2f hull2d_simplexSolve(hull2d_simplex_t* s)
+{
+    Point2f v;
+    float d1, d2, d12_1, d12_2, d13_1, d13_2, d23_1, d23_2;
+    float n123, d123_1, d123_2, d123_3;
+    const Point2f *w1 = &s->w[0], *w2 = &s->w[1], *w3 = &s->w[2];
+
+    if (s->count == 3)
+    {
+        // barycentric weights of every edge and of the triangle, a vertex or
+        // edge is closest if the weights of the rest aren't positive
+        d12_1 = w2->x * (w2->x - w1->x) + w2->y * (w2->y - w1->y);
+        d12_2 = -(w1->x * (w2->x - w1->x) + w1->y * (w2->y - w1->y));
+        d13_1 = w3->x * (w3->x - w1->x) + w3->y * (w3->y - w1->y);
+        d13_2 = -(w1->x * (w3->x - w1->x) + w1->y * (w3->y - w1->y));
+        d23_1 = w3->x * (w3->x - w2->x) + w3->y * (w3->y - w2->y);
+        d23_2 = -(w2->x * (w3->x - w2->x) + w2->y * (w3->y - w2->y));
+
+        n123 = (w2->x - w1->x) * (w3->y - w1->y) -
+               (w2->y - w1->y) * (w3->x - w1->x);
+        d123_1 = n123 * (w2->x * w3->y - w2->y * w3->x);
+        d123_2 = n123 * (w3->x * w1->y - w3->y * w1->x);
+        d123_3 = n123 * (w1->x * w2->y - w1->y * w2->x);
+
+        if (d12_2 <= 0.0f && d13_2 <= 0.0f)
+        {
+            s->count = 1;
+        }
+        else if (d12_1 > 0.0f && d12_2 > 0.0f && d123_3 <= 0.0f)
+        {
+            s->count = 2;
+        }
+        else if (d13_1 > 0.0f && d13_2 > 0.0f && d123_2 <= 0.0f)
+        {
+            hull2d_simplexMove(s, 1, 2);
+            s->count = 2;
+        }
+        else if (d12_1 <= 0.0f && d23_2 <= 0.0f)
+        {
+            hull2d_simplexMove(s, 0, 1);
+            s->count = 1;
+        }
+        else if (d13_1 <= 0.0f && d23_1 <= 0.0f)
+        {
+            hull2d_simplexMove(s, 0, 2);
+            s->count = 1;
+        }
+        else if (d23_1 > 0.0f && d23_2 > 0.0f && d123_1 <= 0.0f)
+        {
+            hull2d_simplexMove(s, 0, 2);
+            s->count = 2;
+        }
+        else
+        {
+            v.x = 0.0f;
+            v.y = 0.0f;
+            return v;
+        }
+    }
+
+    if (s->count == 2)
+    {
+        d1 = w2->x * (w2->x - w1->x) + w2->y * (w2->y - w1->y);
+        d2 = -(w1->x * (w2->x - w1->x) + w1->y * (w2->y - w1->y));
+        if (d2 <= 0.0f)
+        {
+            s->count = 1;
+        }
+        else if (d1 <= 0.0f)
+        {
+            hull2d_simplexMove(s, 0, 1);
+            s->count = 1;
+        }
+        else
+        {
+            v.x = (w1->x * d1 + w2->x * d2) / (d1 + d2);
+            v.y = (w1->y * d1 + w2->y * d2) / (d1 + d2);
+            return v;
+        }
+    }
+
+    return s->w[0];
+}
+
+/**
+* @brief Check if two convex hulls intersect with GJK and find how far apart
+*        they are. Each step takes the point of a simplex in the Minkowski
+*        difference closest to the origin and adds the support point opposite
+*        to it, support points are binary searched so large hulls cost
+*        O(log(n)) per step.
+* @param[in] ha        The first hull
+* @param[in] hb        The second hull
+* @param[out] distance Receives the distance between the hulls, 0 if they
+*                      intersect, may be NULL
+* @return True if ha intersects hb, false otherwise
+*/
+bool_t hull2d_checkIntersectGjk(const hull2d_t* ha, const hull2d_t* hb,
+    float* distance)
+{
+    hull2d_simplex_t s;
+    Point2f v, w;
+    uint32_t iter, k, ia, ib;
+    float vv, gap, dist, tolerance;
+    bool_t hit;
+
+    // assert that hulls have been caluculated
+    LOGASSERT(!ha->dirty && !hb->dirty);
+
+    // support points are a few rounding errors of their coordinates off, so
+    // are the distances measured from them
+    tolerance = fmaxf(fmaxf(fabsf(ha->minX), fabsf(ha->maxX)),
+        fmaxf(fabsf(ha->minY), fabsf(ha->maxY)));
+    tolerance = fmaxf(tolerance, fmaxf(fmaxf(fabsf(hb->minX),
+        fabsf(hb->maxX)), fmaxf(fabsf(hb->minY), fabsf(hb->maxY))));
+    tolerance *= 4.0f * FLT_EPSILON;
+
+    s.idxA[0] = 0;
+    s.idxB[0] = 0;
+    s.w[0].x = ha->vertexX[0] - hb->vertexX[0];
+    s.w[0].y = ha->vertexY[0] - hb->vertexY[0];
+    s.count = 1;
+
+    hit = FALSE;
+    vv = 0.0f;
+    for (iter = 0; iter < HULL2D_GJK_MAX_ITERATIONS; ++iter)
+    {
+        v = hull2d_simplexSolve(&s);
+        vv = v.x * v.x + v.y * v.y;
+        if (s.count == 3 || vv == 0.0f)
+        {
+            hit = TRUE;
+            break;
+        }
+
+        // support point of A - B towards the origin
+        ia = hull2d_support(ha, -v.x, -v.y);
+        ib = hull2d_support(hb, v.x, v.y);
+        w.x = ha->vertexX[ia] - hb->vertexX[ib];
+        w.y = ha->vertexY[ia] - hb->vertexY[ib];
+
+        // done once the support point is already known or gets no closer
+        for (k = 0; k < s.count; ++k)
+        {
+            if (s.idxA[k] == ia && s.idxB[k] == ib)
+            {
+                break;
+            }
+        }
+        gap = vv - (v.x * w.x + v.y * w.y);
+        if (k < s.count || gap <= FLT_EPSILON * vv ||
+            gap <= tolerance * sqrtf(vv))
+        {
+            break;
+        }
+
+        s.w[s.count] = w;
+        s.idxA[s.count] = ia;
+        s.idxB[s.count] = ib;
+        s.count++;
+    }
+
+    // touching hulls come out a rounding error apart
+    dist = hit ? 0.0f : sqrtf(vv);
+    if (dist <= tolerance)
+    {
+        dist = 0.0f;
+    }
+
+    if (distance != NULL)
+    {
+        *distance = dist;
+    }
+    return dist == 0.0f;
+}
+
+/**
+* @brief Return true if a comes before b when sorted by x then y
+* @param[in] a First point
+* @param[in] b Second point
+*/
+static bool_t hull2d_lessXY(const Point2f* a, const Point2f* b)
+{
+    return (a->x < b->x) || (a->x == b->x && a->y < b->y);
+}
+
+/**
+* @brief Split a CCW ring of indices into its lower chain and its reversed
+*        upper chain, both sorted by (x, y)
+* @param[in] hull Pointer to the hull object
+* @param[in] ring First index of the ring
+* @param[in] n    Number of indices in the ring, must be at least one
+* @param[out] runs Receives the lower and upper chains
+*/
+static void hull2d_splitChains(const hull2d_t* hull,
+    const flaggedindex_t* ring, uint32_t n, hull2d_run_t* runs)
+{
+    uint32_t i, left, right;
+
+    left = 0;
+    right = 0;
+    for (i = 1; i < n; ++i)
+    {
+        if (hull2d_lessXY(&hull->points[ring[i].pointIdx],
+                          &hull->points[ring[left].pointIdx]))
+        {
+            left = i;
+        }
+        if (hull2d_lessXY(&hull->points[ring[right].pointIdx],
+                          &hull->points[ring[i].pointIdx]))
+        {
+            right = i;
+        }
+    }
+
+    // lower chain runs CCW from the left-most to the right-most point
+    runs[0].ring = ring;
+    runs[0].size = n;
+    runs[0].pos = left;
+    runs[0].left = (right + n - left) % n + 1;
+    runs[0].step = 1;
+
+    // upper chain runs CW from just before the left-most point
+    runs[1].ring = ring;
+    runs[1].size = n;
+    runs[1].pos = (left + n - 1) % n;
+    runs[1].left = n - runs[0].left;
+    runs[1].step = n - 1;
+}
+
+/**
+* @brief Compute the convex hull of two CCW rings of indices in O(na + nb).
+*        Both rings are split into chains sorted by (x, y), the chains are
+*        merged into scratch space and the monotone chain runs over the
+*        result without sorting.
+* @param[in] hull      Pointer to the hull object
+* @param[in] scratch   Scratch memory of a hull construction context
+* @param[in] ringA     First index of the first ring
+* @param[in] na        Number of indices in the first ring
+* @param[in] ringB     First index of the second ring
+* @param[in] nb        Number of indices in the second ring
+* @param[out] out      Receives the CCW boundary starting at the left-most
+*                      point, may alias either ring
+* @param[in] tolerance Turns with a smaller area count as straight
+* @return Number of indices written to out, less than 3 if the rings have no
+*         interior
+*/
+static uint32_t hull2d_mergeRings(const hull2d_t* hull,
+    const hull2d_chain_t* scratch,
+    const flaggedindex_t* ringA, uint32_t na,
+    const flaggedindex_t* ringB, uint32_t nb, flaggedindex_t* out,
+    double tolerance)
+{
+    hull2d_run_t runs[4];
+    flaggedindex_t* merged;
+    uint32_t i, r, best, n;
+    const Point2f *p, *bestp;
+
+    // the chain uses the bottom of the scratch, the merged list goes above it
+    LOGASSERT((uint32_t)scratch->maxItems >= 2U * (na + nb) + 1U);
+    merged = &scratch->data[na + nb + 1];
+
+    hull2d_splitChains(hull, ringA, na, &runs[0]);
+    hull2d_splitChains(hull, ringB, nb, &runs[2]);
+
+    // merge the four sorted chains
+    n = na + nb;
+    for (i = 0; i < n; ++i)
+    {
+        best = 0;
+        bestp = NULL;
+        for (r = 0; r < 4; ++r)
+        {
+            if (runs[r].left > 0)
+            {
+                p = &hull->points[runs[r].ring[runs[r].pos].pointIdx];
+                if (bestp == NULL || hull2d_lessXY(p, bestp))
+                {
+                    best = r;
+                    bestp = p;
+                }
+            }
+        }
+
+        merged[i] = runs[best].ring[runs[best].pos];
+        runs[best].pos = (runs[best].pos + runs[best].step) % runs[best].size;
+        runs[best].left--;
+    }
+
+    return hull2d_chainSorted(hull, scratch, merged, n, out, tolerance);
+}
+
+/**
+* @brief Finish a hull whose boundary list holds the result of the monotone
+*        chain
+* @param[in/out] hull Pointer to the hull object
+* @return Returns true if the boundary has an interior
+*/
+static bool_t hull2d_finishChain(hull2d_t* hull)
+{
+    // all points on the same line
+    if (hull->boundaryCount < 3)
+    {
+        hull2d_findLowest(hull);
+        return FALSE;
+    }
+
+    // Start the boundary at the lowest point like Graham's algorithm
+    hull2d_rotateToLowest(hull);
+    hull2d_storeVertices(hull);
+    hull2d_findExtremes(hull);
+    hull->dirty = FALSE;
+
+    return TRUE;
+}
+
+/**
+* @brief Compute the convex hull of two computed hulls in O(h1 + h2)
+* @param[out] out      Receives the merged hull, its point list holds the
+*                      boundary points of ha followed by those of hb. Keeps
+*                      its engine settings, must not be ha or hb.
+* @param[in] ha        The first computed hull
+* @param[in] hb        The second computed hull
+* @param[in/out] context A context initialized by hull2d_initContext
+* @return Returns true if the merged hull has an interior, false if it doesn't
+*         or the boundaries don't fit in out
+*/
+bool_t hull2d_merge(hull2d_t* out, const hull2d_t* ha, const hull2d_t* hb,
+    hull2d_context_t* context)
+{
+    uint32_t i;
+
+    // assert that hulls have been caluculated
+    LOGASSERT(!ha->dirty && !hb->dirty);
+    LOGASSERT(out != ha && out != hb);
+
+    hull2d_clear(out);
+    if (ha->boundaryCount + hb->boundaryCount > out->capacity)
+    {
+        return FALSE;
+    }
+
+    // copy both boundaries into the point list, keeping them as rings
+    for (i = 0; i < ha->boundaryCount; ++i)
+    {
+        out->points[i] = *hull2d_vertex(ha, i);
+    }
+    for (i = 0; i < hb->boundaryCount; ++i)
+    {
+        out->points[ha->boundaryCount + i] = *hull2d_vertex(hb, i);
+    }
+    out->pointCount = ha->boundaryCount + hb->boundaryCount;
+
+    for (i = 0; i < out->pointCount; ++i)
+    {
+        out->boundaryIdx[i].pointIdx = i;
+        out->boundaryIdx[i].remove = FALSE;
+    }
+
+    out->boundaryCount = hull2d_mergeRings(out, &context->scratch,
+        &out->boundaryIdx[0], ha->boundaryCount,
+        &out->boundaryIdx[ha->boundaryCount], hb->boundaryCount,
+        out->boundaryIdx, FLT_EPSILON);
+
+    return hull2d_finishChain(out);
+}
+
+/**
+* @brief Compute the hull of a group of blobs. Every blob is hulled on its own
+*        and neighbouring blob hulls are merged pairwise until one is left, so
+*        no step ever sorts more than one blob.
+* @param[in/out] hull  Pointer to the hull object, cleared first and keeps its
+*                      engine settings
+* @param[in] corners   CORNERS_PER_BLOB points for every blob
+* @param[in] blobCount Number of blobs, at most MAX_BLOBS_PER_GROUP
+* @param[in/out] context A context initialized by hull2d_initContext
+* @return Returns true if the group hull has an interior, false if it doesn't
+*         or the corners don't fit in the hull
+*/
+bool_t hull2d_computeGroupHull(hull2d_t* hull, const Point2f* corners,
+    uint32_t blobCount, hull2d_context_t* context)
+{
+    uint32_t size[MAX_BLOBS_PER_GROUP];
+    uint32_t b, count, start, w, merged;
+    double tolerance;
+
+    LOGASSERT(blobCount <= MAX_BLOBS_PER_GROUP);
+
+    hull2d_clear(hull);
+    if (blobCount == 0)
+    {
+        return FALSE;
+    }
+    if (!hull2d_addPoints(hull, corners, blobCount * CORNERS_PER_BLOB))
+    {
+        return FALSE;
+    }
+
+    // hull every blob, packing the blob hulls to the front of the list. Only
+    // the last step uses the tolerance, a tiny blob could otherwise look like
+    // a line and lose a point that is on the group boundary.
+    tolerance = (blobCount == 1) ? FLT_EPSILON : HULL2D_EXACT;
+    w = 0;
+    for (b = 0; b < blobCount; ++b)
+    {
+        size[b] = hull2d_chainSlice(hull, &context->scratch,
+            &hull->boundaryIdx[b * CORNERS_PER_BLOB], CORNERS_PER_BLOB,
+            &hull->boundaryIdx[w], tolerance);
+        w += size[b];
+    }
+
+    // merge neighbouring hulls until one is left
+    count = blobCount;
+    while (count > 1)
+    {
+        tolerance = (count == 2) ? FLT_EPSILON : HULL2D_EXACT;
+        start = 0;
+        w = 0;
+        for (b = 0; b + 1 < count; b += 2)
+        {
+            merged = hull2d_mergeRings(hull, &context->scratch,
+                &hull->boundaryIdx[start], size[b],
+                &hull->boundaryIdx[start + size[b]], size[b + 1],
+                &hull->boundaryIdx[w], tolerance);
+            start += size[b] + size[b + 1];
+            size[b / 2] = merged;
+            w += merged;
+        }
+
+        // odd one out moves down unchanged
+        if (b < count)
+        {
+            memmove(&hull->boundaryIdx[w], &hull->boundaryIdx[start],
+                sizeof(flaggedindex_t) * size[b]);
+            size[b / 2] = size[b];
+        }
+        count = (count + 1) / 2;
+    }
+
+    hull->boundaryCount = size[0];
+
+    return hull2d_finishChain(hull);
+}
+
+/**
+* @brief Point a chain at part of the scratch memory of a context, the workers
+*        of hull2d_computeHullParallel each get their own part
+* @param[out] view    Receives the chain over the scratch memory
+* @param[in] scratch   Scratch memory of a hull construction context
+* @param[in] offset   First item of scratch used by view
+* @param[in] items    Number of items in view
+*/
+static void hull2d_scratchView(hull2d_chain_t* view,
+    const hull2d_chain_t* scratch, uint32_t offset, uint32_t items)
+{
+    LOGASSERT(offset + items <= (uint32_t)scratch->maxItems);
+
+    hull2d_chain_view(view, &scratch->data[offset], (int32_t)items);
+}
+
+/**
+* @brief Pool task hulling one chunk of the boundary list in place. A chunk
+*        over [lo, hi) uses scratch items from 2 lo + c, so the scratch of
+*        two chunks or merges never overlaps.
+* @param[in/out] context The hull2d_parallel_t of the computation
+* @param[in] task        The chunk to hull
+* @param[in] worker      Unused
+*/
+static void hull2d_parallelChunk(void* context, uint32_t task, uint32_t worker)
+{
+    hull2d_parallel_t* par = (hull2d_parallel_t*)context;
+    flaggedindex_t* indices = &par->hull->boundaryIdx[par->start[task]];
+    uint32_t count = par->start[task + 1] - par->start[task];
+    hull2d_chain_t view;
+
+    (void)worker;
+
+    hull2d_scratchView(&view, par->scratch, 2U * par->start[task] + task,
+        count + 1U);
+    par->size[task] = hull2d_chainSlice(par->hull, &view, indices, count,
+        indices, HULL2D_EXACT);
+}
+
+/**
+* @brief Pool task merging the hull of chunk 2 span task with the hull of the
+*        chunk span after it, the result replaces the first hull
+* @param[in/out] context The hull2d_parallel_t of the computation
+* @param[in] task        The merge to run in the current round
+* @param[in] worker      Unused
+*/
+static void hull2d_parallelMerge(void* context, uint32_t task, uint32_t worker)
+{
+    hull2d_parallel_t* par = (hull2d_parallel_t*)context;
+    flaggedindex_t* boundary = par->hull->boundaryIdx;
+    uint32_t a, b, end, lo, hi;
+    hull2d_chain_t view;
+
+    (void)worker;
+
+    a = task * 2U * par->span;
+    b = a + par->span;
+    end = (b + par->span < par->chunkCount) ? b + par->span : par->chunkCount;
+    lo = par->start[a];
+    hi = par->start[end];
+
+    hull2d_scratchView(&view, par->scratch, 2U * lo + a, 2U * (hi - lo) + 1U);
+    par->size[a] = hull2d_mergeRings(par->hull, &view,
+        &boundary[lo], par->size[a],
+        &boundary[par->start[b]], par->size[b],
+        &boundary[lo], par->tolerance);
+}
+
+/**
+* @brief Compute the hull on a pool of workers. The boundary list is split
+*        into one chunk per worker, the chunks are hulled at the same time and
+*        then merged pairwise, every round of merges also running in parallel.
+*        Small point sets fall back to hull2d_computeHull.
+* @param[in/out] hull  Pointer to the hull object, the engine setting is only
+*                      used by the fallback
+* @param[in/out] context A context initialized by hull2d_initContext, its
+*                      scratch memory is split between the workers
+* @param[in/out] pool  The workers, chunks are never smaller than
+*                      HULL2D_PARALLEL_MIN_CHUNK points
+* @return Returns true if able to create a hull false otherwise
+*/
+bool_t hull2d_computeHullParallel(hull2d_t* hull, hull2d_context_t* context,
+    pool_t* pool)
+{
+    hull2d_parallel_t par;
+    uint32_t c, n;
+
+    // nothing to do
+    if (hull->dirty == FALSE)
+    {
+        return TRUE;
+    }
+
+    // verify there are enough points to build a hull
+    if (hull->boundaryCount < 3)
+    {
+        return FALSE;
+    }
+
+    // Culling first may leave too few points to be worth splitting
+    if (hull->cull != HULL2D_CULL_NONE)
+    {
+        hull2d_cull(hull);
+    }
+
+    n = hull->boundaryCount;
+    par.chunkCount = n / HULL2D_PARALLEL_MIN_CHUNK;
+    if (par.chunkCount > pool->workerCount)
+    {
+        par.chunkCount = pool->workerCount;
+    }
+
+    // one chunk is no better than the serial engines
+    if (par.chunkCount < 2)
+    {
+        return hull2d_runEngine(hull, &context->scratch);
+    }
+
+    par.hull = hull;
+    par.scratch = &context->scratch;
+    for (c = 0; c <= par.chunkCount; ++c)
+    {
+        par.start[c] = (uint32_t)((uint64_t)n * c / par.chunkCount);
+    }
+
+    pool_run(pool, hull2d_parallelChunk, &par, par.chunkCount);
+
+    // exact orientation until the last round, see hull2d_computeGroupHull
+    for (par.span = 1; par.span < par.chunkCount; par.span *= 2)
+    {
+        par.tolerance = (2U * par.span >= par.chunkCount) ?
+            FLT_EPSILON : HULL2D_EXACT;
+        pool_run(pool, hull2d_parallelMerge, &par,
+            (par.chunkCount - par.span + 2U * par.span - 1U) /
+            (2U * par.span));
+    }
+
+    hull->boundaryCount = par.size[0];
+
+    return hull2d_finishChain(hull);
+}
+
+/**
+* @brief Pool task of hull2d_computeHulls, computes one hull with the context
+*        of the worker
+* @param[in/out] context The hull2d_batch_t of the batch
+* @param[in] task        Index of the hull
+* @param[in] worker      Index of the worker running the task
+*/
+static void hull2d_batchHull(void* context, uint32_t task, uint32_t worker)
+{
+    hull2d_batch_t* batch = (hull2d_batch_t*)context;
+    hull2d_t* hull = &batch->hulls[task];
+
+    if (hull->dirty && !hull2d_computeHull(hull, &batch->contexts[worker]))
+    {
+        batch->failed[worker]++;
+    }
+}
+
+/**
+* @brief Compute many independent hulls on a pool of workers
+* @param[in/out] hulls    Array of hull objects, each keeps its own settings
+* @param[in] count        Number of hulls
+* @param[in/out] contexts One context initialized by hull2d_initContext for
+*                         every worker of the pool
+* @param[in/out] pool     The workers
+* @return Returns true if every hull was computed, hulls that failed stay
+*         dirty
+*/
+bool_t hull2d_computeHulls(hull2d_t* hulls, uint32_t count,
+    hull2d_context_t* contexts, pool_t* pool)
+{
+    hull2d_batch_t batch;
+    uint32_t w, failed;
+
+    batch.hulls = hulls;
+    batch.contexts = contexts;
+    memset(batch.failed, 0, sizeof(batch.failed));
+
+    // hull sizes vary a lot, stealing evens out the workers
+    pool_runStealing(pool, hull2d_batchHull, &batch, count);
+
+    failed = 0;
+    for (w = 0; w < pool->workerCount; ++w)
+    {
+        failed += batch.failed[w];
+    }
+
+    return (failed == 0);
 }
@@ -13,7 +13,7 @@
 typedef struct displaydata_s
 {
     hull2d_t *h1, *h2;
-    stack_t  *stack;
+    hull2d_context_t *context;
     bool_t    intersect;
     int       appWidth, appHeight;
 } displaydata_t;
@@ -68,13 +68,13 @@ void mouse(int button, int state, int x, int y)
     {
         // add point to h1
         hull2d_addPoint(displaydata.h1, &p);
-        (void)hull2d_computeHull(displaydata.h1, displaydata.stack);
+        (void)hull2d_computeHull(displaydata.h1, displaydata.context);
     }
     else if (button == GLUT_RIGHT_BUTTON)
     {
         // add point to h2
         hull2d_addPoint(displaydata.h2, &p);
-        (void)hull2d_computeHull(displaydata.h2, displaydata.stack);
+        (void)hull2d_computeHull(displaydata.h2, displaydata.context);
     }
     else if (button == GLUT_MIDDLE_BUTTON)
     {
@@ -188,7 +188,7 @@ void display(void)
 */
 int main(int argc, char* argv[])
 {
-    stack_t stack;
+    hull2d_context_t context;
     hull2d_t h1, h2;
 
     Point2f c1, c2;
@@ -197,9 +197,11 @@ int main(int argc, char* argv[])
     int32_t i;
     uint32_t seed;
 
-    // initialize hulls
-    hull2d_init(&h1);
-    hull2d_init(&h2);
+    // initialize hulls, points added with the mouse update the hulls in place
+    (void)hull2d_init(&h1, MAX_POINTS_PER_HULL);
+    (void)hull2d_init(&h2, MAX_POINTS_PER_HULL);
+    hull2d_setIncremental(&h1, TRUE);
+    hull2d_setIncremental(&h2, TRUE);
 
     // define the means and standard deviations
     c1.x = -0.5f;
@@ -233,14 +235,14 @@ int main(int argc, char* argv[])
     }
 
     // Compute the hulls for h1 and h2
-    hull2d_initStack(&stack);
-    (void)hull2d_computeHull(&h1, &stack);
-    (void)hull2d_computeHull(&h2, &stack);
+    (void)hull2d_initContext(&context);
+    (void)hull2d_computeHull(&h1, &context);
+    (void)hull2d_computeHull(&h2, &context);
 
     // Initialize the display data structure
     displaydata.h1        = &h1;
     displaydata.h2        = &h2;
-    displaydata.stack     = &stack;
+    displaydata.context   = &context;
     displaydata.intersect = hull2d_checkIntersect(&h1, &h2);
     displaydata.appHeight = 500;
     displaydata.appWidth = 500;
@@ -0,0 +1,519 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "pool.h"
+
+/**
+* Worker pool used to spread independent work over several processors.
+*
+* The threads sleep on a condition variable between calls to pool_run. Tasks
+* are claimed one at a time from a shared counter so a few long tasks don't
+* hold up the rest.
+*
+* pool_runStealing gives every worker its own contiguous range of tasks
+* behind its own lock instead. A worker that finishes its range steals the
+* back half of another worker's range, so short tasks never queue on one lock
+* and uneven task costs still even out.
+*
+* Uses Win32 threads on windows and POSIX threads everywhere else.
+*/
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+typedef HANDLE             pool_thread_t;
+typedef CRITICAL_SECTION   pool_mutex_t;
+typedef CONDITION_VARIABLE pool_cond_t;
+
+#define pool_mutexInit(m)    InitializeCriticalSection(m)
+#define pool_mutexDestroy(m) DeleteCriticalSection(m)
+#define pool_lock(m)         EnterCriticalSection(m)
+#define pool_unlock(m)       LeaveCriticalSection(m)
+#define pool_condInit(c)     InitializeConditionVariable(c)
+#define pool_condDestroy(c)  ((void)(c))
+#define pool_wait(c,m)       SleepConditionVariableCS(c, m, INFINITE)
+#define pool_broadcast(c)    WakeAllConditionVariable(c)
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_t          pool_thread_t;
+typedef pthread_mutex_t    pool_mutex_t;
+typedef pthread_cond_t     pool_cond_t;
+
+#define pool_mutexInit(m)    pthread_mutex_init(m, NULL)
+#define pool_mutexDestroy(m) pthread_mutex_destroy(m)
+#define pool_lock(m)         pthread_mutex_lock(m)
+#define pool_unlock(m)       pthread_mutex_unlock(m)
+#define pool_condInit(c)     pthread_cond_init(c, NULL)
+#define pool_condDestroy(c)  pthread_cond_destroy(c)
+#define pool_wait(c,m)       pthread_cond_wait(c, m)
+#define pool_broadcast(c)    pthread_cond_broadcast(c)
+
+#endif
+
+// Tasks [begin, end) not yet claimed by a worker of pool_runStealing
+typedef struct pool_range_s
+{
+    pool_mutex_t  mutex;
+    uint32_t      begin;
+    uint32_t      end;
+} pool_range_t;
+
+typedef struct pool_impl_s
+{
+    pool_thread_t threads[POOL_MAX_WORKERS];
+    uint32_t      threadCount;
+    pool_range_t  ranges[POOL_MAX_WORKERS];
+
+    pool_mutex_t  mutex;
+    pool_cond_t   wake;       // signalled when a batch starts or on shutdown
+    pool_cond_t   done;       // signalled when the last task finishes
+
+    // current batch, protected by mutex
+    pool_fn_t     fn;
+    void*         context;
+    uint32_t      taskCount;
+    uint32_t      nextTask;
+    uint32_t      remaining;
+    uint32_t      generation;
+    bool_t        stealing;   // tasks are claimed from ranges
+    uint32_t      stealers;   // workers inside pool_drainStealing
+    bool_t        quit;
+} pool_impl_t;
+
+typedef struct pool_start_s
+{
+    pool_impl_t* impl;
+    uint32_t     worker;
+} pool_start_t;
+
+/**
+* @brief Claim and run tasks of the current batch until none are left. Must
+*        be called with the mutex held, returns with the mutex held.
+* @param[in/out] impl Pointer to the pool internals
+* @param[in] worker   Index of the calling worker
+*/
+static void pool_drain(pool_impl_t* impl, uint32_t worker)
+{
+    uint32_t task;
+    pool_fn_t fn;
+    void* context;
+
+    while (impl->nextTask < impl->taskCount)
+    {
+        task = impl->nextTask++;
+        fn = impl->fn;
+        context = impl->context;
+
+        pool_unlock(&impl->mutex);
+        fn(context, task, worker);
+        pool_lock(&impl->mutex);
+
+        if (--impl->remaining == 0)
+        {
+            pool_broadcast(&impl->done);
+        }
+    }
+}
+
+/**
+* @brief Claim the first task of a worker's own range
+* @param[in/out] range The worker's range
+* @param[out] task     Receives the task
+* @return Returns false if the range is empty
+*/
+static bool_t pool_claim(pool_range_t* range, uint32_t* task)
+{
+    bool_t claimed;
+
+    pool_lock(&range->mutex);
+    claimed = (range->begin < range->end);
+    if (claimed)
+    {
+        *task = range->begin++;
+    }
+    pool_unlock(&range->mutex);
+
+    return claimed;
+}
+
+/**
+* @brief Move the back half of another worker's range into a worker's empty
+*        range, trying the other workers in turn
+* @param[in/out] impl Pointer to the pool internals
+* @param[in] worker   Index of the stealing worker
+* @return Returns false if every range is empty
+*/
+static bool_t pool_steal(pool_impl_t* impl, uint32_t worker)
+{
+    uint32_t workerCount = impl->threadCount + 1;
+    uint32_t i, begin, end;
+    pool_range_t* victim;
+
+    for (i = 1; i < workerCount; ++i)
+    {
+        victim = &impl->ranges[(worker + i) % workerCount];
+
+        pool_lock(&victim->mutex);
+        end = victim->end;
+        begin = end - (end - victim->begin) / 2;
+
+        // the last task of a range is taken whole
+        if (begin == end && victim->begin < end)
+        {
+            begin = victim->begin;
+        }
+        victim->end = begin;
+        pool_unlock(&victim->mutex);
+
+        if (begin < end)
+        {
+            pool_lock(&impl->ranges[worker].mutex);
+            impl->ranges[worker].begin = begin;
+            impl->ranges[worker].end = end;
+            pool_unlock(&impl->ranges[worker].mutex);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+* @brief Run tasks of a pool_runStealing batch from a worker's own range and
+*        steal more until none are left. Must be called with the mutex held,
+*        returns with the mutex held.
+* @param[in/out] impl Pointer to the pool internals
+* @param[in] worker   Index of the calling worker
+*/
+static void pool_drainStealing(pool_impl_t* impl, uint32_t worker)
+{
+    pool_fn_t fn = impl->fn;
+    void* context = impl->context;
+    uint32_t task, done;
+
+    impl->stealers++;
+    pool_unlock(&impl->mutex);
+
+    done = 0;
+    for (;;)
+    {
+        if (!pool_claim(&impl->ranges[worker], &task))
+        {
+            if (!pool_steal(impl, worker))
+            {
+                break;
+            }
+            continue;
+        }
+        fn(context, task, worker);
+        done++;
+    }
+
+    pool_lock(&impl->mutex);
+    impl->stealers--;
+    impl->remaining -= done;
+    if (impl->remaining == 0 || impl->stealers == 0)
+    {
+        pool_broadcast(&impl->done);
+    }
+}
+
+/**
+* @brief Body of every pool thread, sleeps until a batch starts
+* @param[in] start Pointer to the pool internals and the worker index
+*/
+static void pool_main(pool_start_t start)
+{
+    pool_impl_t* impl = start.impl;
+    uint32_t seen;
+
+    pool_lock(&impl->mutex);
+    seen = impl->generation;
+    while (!impl->quit)
+    {
+        if (impl->generation == seen)
+        {
+            pool_wait(&impl->wake, &impl->mutex);
+            continue;
+        }
+        seen = impl->generation;
+        if (impl->stealing)
+        {
+            pool_drainStealing(impl, start.worker);
+        }
+        else
+        {
+            pool_drain(impl, start.worker);
+        }
+    }
+    pool_unlock(&impl->mutex);
+}
+
+#ifdef _WIN32
+
+static DWORD WINAPI pool_entry(LPVOID arg)
+{
+    pool_start_t start = *(pool_start_t*)arg;
+    free(arg);
+    pool_main(start);
+    return 0;
+}
+
+static bool_t pool_spawn(pool_thread_t* thread, pool_start_t* start)
+{
+    *thread = CreateThread(NULL, 0, pool_entry, start, 0, NULL);
+    return (*thread != NULL);
+}
+
+static void pool_join(pool_thread_t thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+uint32_t pool_coreCount(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ?
+        (uint32_t)info.dwNumberOfProcessors : 1U;
+}
+
+#else
+
+static void* pool_entry(void* arg)
+{
+    pool_start_t start = *(pool_start_t*)arg;
+    free(arg);
+    pool_main(start);
+    return NULL;
+}
+
+static bool_t pool_spawn(pool_thread_t* thread, pool_start_t* start)
+{
+    return (pthread_create(thread, NULL, pool_entry, start) == 0);
+}
+
+static void pool_join(pool_thread_t thread)
+{
+    (void)pthread_join(thread, NULL);
+}
+
+uint32_t pool_coreCount(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (uint32_t)count : 1U;
+}
+
+#endif
+
+/**
+* @brief Initialize a pool and start its threads
+* @param[in/out] pool   Pointer to an uninitialized pool object
+* @param[in] workerCount Number of workers including the calling thread, 0 to
+*                        use one worker per processor
+* @return Returns false if the threads could not be started
+*/
+bool_t pool_init(pool_t* pool, uint32_t workerCount)
+{
+    pool_impl_t* impl;
+    pool_start_t* start;
+    uint32_t i;
+
+    if (workerCount == 0)
+    {
+        workerCount = pool_coreCount();
+    }
+    if (workerCount > POOL_MAX_WORKERS)
+    {
+        workerCount = POOL_MAX_WORKERS;
+    }
+
+    pool->workerCount = 1;
+    pool->impl = (pool_impl_t*)calloc(1, sizeof(pool_impl_t));
+    if (pool->impl == NULL)
+    {
+        return FALSE;
+    }
+
+    impl = pool->impl;
+    pool_mutexInit(&impl->mutex);
+    pool_condInit(&impl->wake);
+    pool_condInit(&impl->done);
+    for (i = 0; i < POOL_MAX_WORKERS; ++i)
+    {
+        pool_mutexInit(&impl->ranges[i].mutex);
+    }
+
+    // the calling thread is worker 0
+    for (i = 1; i < workerCount; ++i)
+    {
+        start = (pool_start_t*)malloc(sizeof(pool_start_t));
+        if (start == NULL)
+        {
+            break;
+        }
+        start->impl = impl;
+        start->worker = i;
+        if (!pool_spawn(&impl->threads[impl->threadCount], start))
+        {
+            free(start);
+            break;
+        }
+        impl->threadCount++;
+    }
+    pool->workerCount = impl->threadCount + 1;
+
+    if (pool->workerCount != workerCount)
+    {
+        pool_destroy(pool);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+* @brief Stop the threads of a pool and free its resources
+* @param[in/out] pool Pointer to the pool object
+*/
+void pool_destroy(pool_t* pool)
+{
+    pool_impl_t* impl = pool->impl;
+    uint32_t i;
+
+    if (impl == NULL)
+    {
+        return;
+    }
+
+    pool_lock(&impl->mutex);
+    impl->quit = TRUE;
+    pool_broadcast(&impl->wake);
+    pool_unlock(&impl->mutex);
+
+    for (i = 0; i < impl->threadCount; ++i)
+    {
+        pool_join(impl->threads[i]);
+    }
+
+    for (i = 0; i < POOL_MAX_WORKERS; ++i)
+    {
+        pool_mutexDestroy(&impl->ranges[i].mutex);
+    }
+    pool_condDestroy(&impl->done);
+    pool_condDestroy(&impl->wake);
+    pool_mutexDestroy(&impl->mutex);
+    free(impl);
+
+    pool->impl = NULL;
+    pool->workerCount = 0;
+}
+
+/**
+* @brief Run taskCount tasks on the pool and wait for all of them to finish.
+*        The calling thread works on tasks too.
+* @param[in/out] pool    Pointer to the pool object
+* @param[in] fn          Function called once for every task
+* @param[in/out] context Pointer passed to every call of fn
+* @param[in] taskCount   Number of tasks
+*/
+void pool_run(pool_t* pool, pool_fn_t fn, void* context, uint32_t taskCount)
+{
+    pool_impl_t* impl = pool->impl;
+    uint32_t task;
+
+    if (taskCount == 0)
+    {
+        return;
+    }
+
+    // nothing to hand out, skip the locking
+    if (impl->threadCount == 0 || taskCount == 1)
+    {
+        for (task = 0; task < taskCount; ++task)
+        {
+            fn(context, task, 0);
+        }
+        return;
+    }
+
+    pool_lock(&impl->mutex);
+    impl->fn = fn;
+    impl->context = context;
+    impl->taskCount = taskCount;
+    impl->nextTask = 0;
+    impl->remaining = taskCount;
+    impl->stealing = FALSE;
+    impl->generation++;
+    pool_broadcast(&impl->wake);
+
+    pool_drain(impl, 0);
+    while (impl->remaining > 0)
+    {
+        pool_wait(&impl->done, &impl->mutex);
+    }
+    pool_unlock(&impl->mutex);
+}
+
+/**
+* @brief Same as pool_run, every worker starts on its own contiguous range of
+*        tasks and steals from the others when its range runs out
+* @param[in/out] pool    Pointer to the pool object
+* @param[in] fn          Function called once for every task
+* @param[in/out] context Pointer passed to every call of fn
+* @param[in] taskCount   Number of tasks
+*/
+void pool_runStealing(pool_t* pool, pool_fn_t fn, void* context,
+    uint32_t taskCount)
+{
+    pool_impl_t* impl = pool->impl;
+    uint32_t workerCount = impl->threadCount + 1;
+    uint32_t w;
+
+    if (impl->threadCount == 0 || taskCount <= 1)
+    {
+        pool_run(pool, fn, context, taskCount);
+        return;
+    }
+
+    pool_lock(&impl->mutex);
+
+    // a worker that woke up late for the last batch may still be looking
+    // for work in the old ranges
+    while (impl->stealers > 0)
+    {
+        pool_wait(&impl->done, &impl->mutex);
+    }
+
+    for (w = 0; w < workerCount; ++w)
+    {
+        pool_lock(&impl->ranges[w].mutex);
+        impl->ranges[w].begin =
+            (uint32_t)((uint64_t)taskCount * w / workerCount);
+        impl->ranges[w].end =
+            (uint32_t)((uint64_t)taskCount * (w + 1) / workerCount);
+        pool_unlock(&impl->ranges[w].mutex);
+    }
+
+    impl->fn = fn;
+    impl->context = context;
+    impl->taskCount = taskCount;
+    impl->remaining = taskCount;
+    impl->stealing = TRUE;
+    impl->generation++;
+    pool_broadcast(&impl->wake);
+
+    pool_drainStealing(impl, 0);
+    while (impl->remaining > 0)
+    {
+        pool_wait(&impl->done, &impl->mutex);
+    }
+    pool_unlock(&impl->mutex);
+}
@@ -30,24 +30,36 @@ void stack_clear(stack_t* stack)
 * @brief Push onto the stack
 * @param[in/out] stack Pointer to the stack
 * @param[in] item      Pointer to the item to put on the stack
-* @return Returns false if the stack is full after inserting the item
+* @return Returns false if the stack is full, the item is not added
 */
 bool_t stack_push(stack_t* stack, const void* item)
 {
     char* data = stack->data;
+
+    if (stack->top + 1 >= stack->maxItems)
+    {
+        return FALSE;
+    }
+
     memcpy(&data[++stack->top * stack->itemSize], item,
         (size_t)stack->itemSize);
 
-    return (stack->top < stack->maxItems);
+    return TRUE;
 }
 
 /**
 * @brief Pop the top item from the stack
 * @param[in/out] stack Pointer to the stack
-* @return Returns false if the stack is empty after poping
+* @return Returns false if the stack is empty after poping, popping an empty
+*         stack leaves it empty
 */
 bool_t stack_pop(stack_t* stack)
 {
+    if (stack->top < 0)
+    {
+        return FALSE;
+    }
+
     stack->top--;
     return !(stack->top < 0);
 }
@@ -0,0 +1,1587 @@
+#include "world2d.h"
+
+/**
+* Collision world for many hulls using sweep and prune
+*
+* Every hull gets an axis aligned bounding box. The handles are kept sorted by
+* the left edge of their boxes, a sweep along x then only compares boxes whose
+* x ranges overlap and tests their y ranges. Hulls move little from one frame
+* to the next so the order is restored with an insertion sort.
+*
+* The grid broad phase instead hashes every cell a box covers into a table of
+* buckets, rebuilt from scratch with a counting sort on every update. Two
+* boxes can only overlap if they share a cell, and a pair sharing several
+* cells is only reported by the cell holding the corner of their overlap
+* with the lowest x and y.
+*
+* The tree broad phase keeps the boxes, enlarged by a margin, as leaves of a
+* dynamic bounding volume tree. A hull is only reinserted once its box leaves
+* the enlarged one, inserts pick the sibling that least grows the perimeter
+* of the tree and rotations on the way back up keep the tree balanced.
+*
+* Complexity
+* For n hulls with k pairs of boxes overlapping along x
+*   Sweep update: O(n) when the order barely changes, O(n^2) worst case
+*   Sweep pairs: O(n + k)
+* For n hulls covering c cells with at most m hulls in a cell
+*   Grid update: O(n + c)
+*   Grid pairs: O(c * m)
+* For n hulls of which r left their enlarged box, with k pairs of overlapping
+* enlarged boxes
+*   Tree update: O(n + r * log(n))
+*   Tree pairs: O(n + k) for a well balanced tree
+*/
+
+// Smallest number of hash buckets
+#define WORLD2D_MIN_BUCKETS (16U)
+
+// Cell coordinates are clamped to +-2^30 so they fit an int32_t
+#define WORLD2D_MAX_CELL (1073741824.0f)
+
+// The grid uses larger cells than requested rather than store more than this
+// many cells per hull on average
+#define WORLD2D_MAX_CELLS_PER_HULL (64U)
+
+// Tree leaves enlarge the box of their hull by this fraction of its size
+#define WORLD2D_FAT_MARGIN (0.1f)
+
+/**
+* @brief Get the bounding box of a hull, cached by hull2d_computeHull
+* @param[in] hull Pointer to the hull object
+* @param[out] box Receives the bounding box, empty if the hull is dirty
+*/
+static void world2d_hullBox(const hull2d_t* hull, world2d_box_t* box)
+{
+    if (hull->dirty)
+    {
+        box->minX = FLT_MAX;
+        box->minY = FLT_MAX;
+        box->maxX = -FLT_MAX;
+        box->maxY = -FLT_MAX;
+        return;
+    }
+
+    box->minX = hull->minX;
+    box->minY = hull->minY;
+    box->maxX = hull->maxX;
+    box->maxY = hull->maxY;
+}
+
+/**
+* @brief Compute the box enclosing two boxes
+* @param[in] a    First box
+* @param[in] b    Second box
+* @param[out] out Receives the enclosing box, may be a or b
+*/
+static void world2d_union(const world2d_box_t* a, const world2d_box_t* b,
+    world2d_box_t* out)
+{
+    out->minX = (a->minX < b->minX) ? a->minX : b->minX;
+    out->minY = (a->minY < b->minY) ? a->minY : b->minY;
+    out->maxX = (a->maxX > b->maxX) ? a->maxX : b->maxX;
+    out->maxY = (a->maxY > b->maxY) ? a->maxY : b->maxY;
+}
+
+/**
+* @brief Get the perimeter of a box, the cost the tree inserts minimize
+* @param[in] box The box
+* @return Returns the perimeter
+*/
+static float world2d_perimeter(const world2d_box_t* box)
+{
+    return 2.0f * ((box->maxX - box->minX) + (box->maxY - box->minY));
+}
+
+/**
+* @brief Check if a box encloses another
+* @param[in] outer The enclosing box
+* @param[in] inner The enclosed box
+* @return Returns true if inner lies within outer
+*/
+static bool_t world2d_contains(const world2d_box_t* outer,
+    const world2d_box_t* inner)
+{
+    return outer->minX <= inner->minX && outer->minY <= inner->minY &&
+           outer->maxX >= inner->maxX && outer->maxY >= inner->maxY;
+}
+
+/**
+* @brief Enlarge a box by a margin on every side
+* @param[in] box    The box
+* @param[in] margin The margin
+* @param[out] out   Receives the enlarged box
+*/
+static void world2d_grow(const world2d_box_t* box, float margin,
+    world2d_box_t* out)
+{
+    out->minX = box->minX - margin;
+    out->minY = box->minY - margin;
+    out->maxX = box->maxX + margin;
+    out->maxY = box->maxY + margin;
+}
+
+/**
+* @brief Empty the tree and put every node on the free list
+* @param[in/out] world Pointer to the world
+*/
+static void world2d_clearTree(world2d_t* world)
+{
+    uint32_t i, nodeCount = 2 * world->capacity;
+
+    for (i = 0; i < nodeCount; ++i)
+    {
+        world->nodes[i].parent = (i + 1 < nodeCount) ?
+            i + 1 : WORLD2D_INVALID_HANDLE;
+        world->nodes[i].height = -1;
+    }
+    for (i = 0; i < world->capacity; ++i)
+    {
+        world->leaves[i] = WORLD2D_INVALID_HANDLE;
+    }
+
+    world->root = WORLD2D_INVALID_HANDLE;
+    world->freeNode = (nodeCount > 0) ? 0 : WORLD2D_INVALID_HANDLE;
+}
+
+/**
+* @brief Take a node off the free list, there is always one as a tree over
+*        capacity leaves never needs more than 2 * capacity nodes
+* @param[in/out] world Pointer to the world
+* @return Returns the index of the node, a leaf without a hull
+*/
+static uint32_t world2d_allocNode(world2d_t* world)
+{
+    uint32_t index = world->freeNode;
+    world2d_node_t* node;
+
+    LOGASSERT(index != WORLD2D_INVALID_HANDLE);
+
+    node = &world->nodes[index];
+    world->freeNode = node->parent;
+    node->parent = WORLD2D_INVALID_HANDLE;
+    node->child1 = WORLD2D_INVALID_HANDLE;
+    node->child2 = WORLD2D_INVALID_HANDLE;
+    node->handle = WORLD2D_INVALID_HANDLE;
+    node->height = 0;
+
+    return index;
+}
+
+/**
+* @brief Return a node to the free list
+* @param[in/out] world Pointer to the world
+* @param[in] index     Index of the node
+*/
+static void world2d_freeNode(world2d_t* world, uint32_t index)
+{
+    world->nodes[index].parent = world->freeNode;
+    world->nodes[index].height = -1;
+    world->freeNode = index;
+}
+
+/**
+* @brief Point the parent of a node, or the root, at a replacement node
+* @param[in/out] world Pointer to the world
+* @param[in] parent    Parent of the replaced node, invalid for the root
+* @param[in] index     The replaced node
+* @param[in] with      The replacement node
+*/
+static void world2d_replaceChild(world2d_t* world, uint32_t parent,
+    uint32_t index, uint32_t with)
+{
+    if (parent == WORLD2D_INVALID_HANDLE)
+    {
+        world->root = with;
+    }
+    else if (world->nodes[parent].child1 == index)
+    {
+        world->nodes[parent].child1 = with;
+    }
+    else
+    {
+        world->nodes[parent].child2 = with;
+    }
+}
+
+/**
+* @brief Rotate a child of a node up into the place of the node. The taller
+*        child of the rising node stays with it, the shorter one moves down.
+* @param[in/out] world Pointer to the world
+* @param[in] indexA    The node to rotate down
+* @param[in] up2       True to rotate child2 of the node up, else child1
+* @return Returns the index of the node now in the place of node A
+*/
+static uint32_t world2d_rotate(world2d_t* world, uint32_t indexA, bool_t up2)
+{
+    world2d_node_t* nodes = world->nodes;
+    world2d_node_t *a, *up, *stay, *tall, *low;
+    uint32_t indexUp, indexTall, indexLow;
+
+    a = &nodes[indexA];
+    indexUp = up2 ? a->child2 : a->child1;
+    stay = &nodes[up2 ? a->child1 : a->child2];
+    up = &nodes[indexUp];
+
+    indexTall = up->child2;
+    indexLow = up->child1;
+    if (nodes[indexLow].height > nodes[indexTall].height)
+    {
+        indexTall = up->child1;
+        indexLow = up->child2;
+    }
+    tall = &nodes[indexTall];
+    low = &nodes[indexLow];
+
+    // the rising node takes the place of node A under its parent
+    up->parent = a->parent;
+    world2d_replaceChild(world, up->parent, indexA, indexUp);
+    up->child1 = indexA;
+    up->child2 = indexTall;
+    a->parent = indexUp;
+
+    // and node A gets the shorter child in place of the rising node
+    if (up2)
+    {
+        a->child2 = indexLow;
+    }
+    else
+    {
+        a->child1 = indexLow;
+    }
+    low->parent = indexA;
+
+    world2d_union(&stay->box, &low->box, &a->box);
+    a->height = 1 + ((stay->height > low->height) ?
+        stay->height : low->height);
+    world2d_union(&a->box, &tall->box, &up->box);
+    up->height = 1 + ((a->height > tall->height) ? a->height : tall->height);
+
+    return indexUp;
+}
+
+/**
+* @brief Rotate the taller child of a node up if its children differ in
+*        height by more than one
+* @param[in/out] world Pointer to the world
+* @param[in] index     The node
+* @return Returns the index of the node now in its place
+*/
+static uint32_t world2d_balance(world2d_t* world, uint32_t index)
+{
+    const world2d_node_t* node = &world->nodes[index];
+    int32_t balance;
+
+    if (node->child1 == WORLD2D_INVALID_HANDLE || node->height < 2)
+    {
+        return index;
+    }
+
+    balance = world->nodes[node->child2].height -
+              world->nodes[node->child1].height;
+    if (balance > 1)
+    {
+        return world2d_rotate(world, index, TRUE);
+    }
+    if (balance < -1)
+    {
+        return world2d_rotate(world, index, FALSE);
+    }
+    return index;
+}
+
+/**
+* @brief Balance a node and every node above it and refit their boxes
+* @param[in/out] world Pointer to the world
+* @param[in] index     The lowest node to fix
+*/
+static void world2d_fixUpwards(world2d_t* world, uint32_t index)
+{
+    world2d_node_t *node, *child1, *child2;
+
+    while (index != WORLD2D_INVALID_HANDLE)
+    {
+        index = world2d_balance(world, index);
+        node = &world->nodes[index];
+        child1 = &world->nodes[node->child1];
+        child2 = &world->nodes[node->child2];
+
+        node->height = 1 + ((child1->height > child2->height) ?
+            child1->height : child2->height);
+        world2d_union(&child1->box, &child2->box, &node->box);
+
+        index = node->parent;
+    }
+}
+
+/**
+* @brief Get the cost of inserting a box below a node, not counting the
+*        growth of the nodes above it
+* @param[in] world Pointer to the world
+* @param[in] index The node
+* @param[in] box   The box to insert
+* @return Returns the growth in perimeter
+*/
+static float world2d_descendCost(const world2d_t* world, uint32_t index,
+    const world2d_box_t* box)
+{
+    const world2d_node_t* node = &world->nodes[index];
+    world2d_box_t joined;
+    float cost;
+
+    world2d_union(&node->box, box, &joined);
+    cost = world2d_perimeter(&joined);
+
+    // a leaf gets a new parent of that size, an inner node grows
+    if (node->child1 != WORLD2D_INVALID_HANDLE)
+    {
+        cost -= world2d_perimeter(&node->box);
+    }
+    return cost;
+}
+
+/**
+* @brief Insert a leaf into the tree next to the sibling that least grows the
+*        perimeter of the tree
+* @param[in/out] world Pointer to the world
+* @param[in] leaf      The leaf, its box already set
+*/
+static void world2d_insertLeaf(world2d_t* world, uint32_t leaf)
+{
+    world2d_node_t* nodes = world->nodes;
+    const world2d_box_t* box = &nodes[leaf].box;
+    world2d_box_t joined;
+    uint32_t index, sibling, parent, oldParent;
+    float perimeter, cost, inherited, cost1, cost2;
+
+    if (world->root == WORLD2D_INVALID_HANDLE)
+    {
+        world->root = leaf;
+        nodes[leaf].parent = WORLD2D_INVALID_HANDLE;
+        return;
+    }
+
+    // descend while a child is a cheaper sibling than the current node
+    index = world->root;
+    while (nodes[index].child1 != WORLD2D_INVALID_HANDLE)
+    {
+        perimeter = world2d_perimeter(&nodes[index].box);
+        world2d_union(&nodes[index].box, box, &joined);
+        cost = 2.0f * world2d_perimeter(&joined);
+
+        // every node below this one pays for growing it
+        inherited = 2.0f * (world2d_perimeter(&joined) - perimeter);
+        cost1 = world2d_descendCost(world, nodes[index].child1, box) +
+            inherited;
+        cost2 = world2d_descendCost(world, nodes[index].child2, box) +
+            inherited;
+
+        if (cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+        index = (cost1 < cost2) ? nodes[index].child1 : nodes[index].child2;
+    }
+
+    // join the leaf and its sibling under a new parent
+    sibling = index;
+    oldParent = nodes[sibling].parent;
+    parent = world2d_allocNode(world);
+    nodes[parent].parent = oldParent;
+    nodes[parent].child1 = sibling;
+    nodes[parent].child2 = leaf;
+    world2d_replaceChild(world, oldParent, sibling, parent);
+    nodes[sibling].parent = parent;
+    nodes[leaf].parent = parent;
+
+    world2d_fixUpwards(world, parent);
+}
+
+/**
+* @brief Remove a leaf from the tree, the leaf node itself is kept
+* @param[in/out] world Pointer to the world
+* @param[in] leaf      The leaf
+*/
+static void world2d_removeLeaf(world2d_t* world, uint32_t leaf)
+{
+    world2d_node_t* nodes = world->nodes;
+    uint32_t parent, grandParent, sibling;
+
+    if (leaf == world->root)
+    {
+        world->root = WORLD2D_INVALID_HANDLE;
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    parent = nodes[leaf].parent;
+    grandParent = nodes[parent].parent;
+    sibling = (nodes[parent].child1 == leaf) ?
+        nodes[parent].child2 : nodes[parent].child1;
+
+    world2d_replaceChild(world, grandParent, parent, sibling);
+    nodes[sibling].parent = grandParent;
+    world2d_freeNode(world, parent);
+
+    world2d_fixUpwards(world, grandParent);
+}
+
+/**
+* @brief Move the leaf of a hull after its box changed. The leaf stays in
+*        place while its enlarged box still holds the box and isn't much
+*        larger than needed.
+* @param[in/out] world Pointer to the world
+* @param[in] handle    Handle of the hull
+*/
+static void world2d_refitLeaf(world2d_t* world, uint32_t handle)
+{
+    const world2d_box_t* box = &world->boxes[handle];
+    world2d_box_t loose;
+    uint32_t leaf = world->leaves[handle];
+    float margin;
+
+    // dirty hulls have no leaf
+    if (box->minX > box->maxX)
+    {
+        if (leaf != WORLD2D_INVALID_HANDLE)
+        {
+            world2d_removeLeaf(world, leaf);
+            world2d_freeNode(world, leaf);
+            world->leaves[handle] = WORLD2D_INVALID_HANDLE;
+        }
+        return;
+    }
+
+    margin = WORLD2D_FAT_MARGIN * ((box->maxX - box->minX > box->maxY -
+        box->minY) ? box->maxX - box->minX : box->maxY - box->minY);
+
+    if (leaf != WORLD2D_INVALID_HANDLE)
+    {
+        world2d_grow(box, 5.0f * margin, &loose);
+        if (world2d_contains(&world->nodes[leaf].box, box) &&
+            world2d_contains(&loose, &world->nodes[leaf].box))
+        {
+            return;
+        }
+        world2d_removeLeaf(world, leaf);
+    }
+    else
+    {
+        leaf = world2d_allocNode(world);
+        world->nodes[leaf].handle = handle;
+        world->leaves[handle] = leaf;
+    }
+
+    world2d_grow(box, margin, &world->nodes[leaf].box);
+    world2d_insertLeaf(world, leaf);
+}
+
+/**
+* @brief Initialize a world and allocate room for its hulls
+* @param[in/out] world Pointer to an uninitialized world
+* @param[in] capacity  Maximum number of hulls
+* @return Returns false if the memory could not be allocated
+*/
+bool_t world2d_init(world2d_t* world, uint32_t capacity)
+{
+    world->count = 0;
+    world->capacity = capacity;
+    world->hulls = (const hull2d_t**)malloc(sizeof(hull2d_t*) * capacity);
+    world->boxes = (world2d_box_t*)malloc(sizeof(world2d_box_t) * capacity);
+    world->order = (uint32_t*)malloc(sizeof(uint32_t) * capacity);
+    world->broadphase = WORLD2D_BROADPHASE_SWEEP;
+    world->narrowphase = WORLD2D_NARROWPHASE_EDGES;
+    world->cellSize = 0.0f;
+    world->invCell = 1.0f;
+    world->cells = NULL;
+    world->cellCount = 0;
+    world->cellCapacity = 0;
+    world->buckets = NULL;
+    world->bucketCount = 0;
+    world->nodes = (world2d_node_t*)malloc(sizeof(world2d_node_t) * 2 *
+        capacity);
+    world->leaves = (uint32_t*)malloc(sizeof(uint32_t) * capacity);
+
+    if (world->hulls == NULL || world->boxes == NULL || world->order == NULL ||
+        world->nodes == NULL || world->leaves == NULL)
+    {
+        world2d_destroy(world);
+        return FALSE;
+    }
+
+    world2d_clearTree(world);
+    return TRUE;
+}
+
+/**
+* @brief Free the memory of a world, the hulls are left alone
+* @param[in/out] world Pointer to the world
+*/
+void world2d_destroy(world2d_t* world)
+{
+    free((void*)world->hulls);
+    free(world->boxes);
+    free(world->order);
+    free(world->cells);
+    free(world->buckets);
+    free(world->nodes);
+    free(world->leaves);
+
+    world->hulls = NULL;
+    world->boxes = NULL;
+    world->order = NULL;
+    world->count = 0;
+    world->capacity = 0;
+    world->cells = NULL;
+    world->cellCount = 0;
+    world->cellCapacity = 0;
+    world->buckets = NULL;
+    world->bucketCount = 0;
+    world->nodes = NULL;
+    world->leaves = NULL;
+    world->root = WORLD2D_INVALID_HANDLE;
+}
+
+/**
+* @brief Select the broad phase, takes effect on the next world2d_update
+* @param[in/out] world  Pointer to the world
+* @param[in] broadphase The broad phase algorithm
+*/
+void world2d_setBroadphase(world2d_t* world, world2d_broadphase_t broadphase)
+{
+    world->broadphase = broadphase;
+
+    // the grid and the tree report nothing until the next update fills them
+    world->cellCount = 0;
+    if (world->buckets != NULL)
+    {
+        memset(world->buckets, 0, sizeof(uint32_t) * (world->bucketCount + 1));
+    }
+    world2d_clearTree(world);
+}
+
+/**
+* @brief Select the intersection test run on the broad phase pairs
+* @param[in/out] world   Pointer to the world
+* @param[in] narrowphase The intersection test
+*/
+void world2d_setNarrowphase(world2d_t* world,
+    world2d_narrowphase_t narrowphase)
+{
+    world->narrowphase = narrowphase;
+}
+
+/**
+* @brief Set the cell size of the grid broad phase
+* @param[in/out] world Pointer to the world
+* @param[in] cellSize  Width and height of a cell, 0 to use the average box
+*                      size of the hulls in the world
+*/
+void world2d_setCellSize(world2d_t* world, float cellSize)
+{
+    world->cellSize = (cellSize > 0.0f) ? cellSize : 0.0f;
+}
+
+/**
+* @brief Add a hull to the world
+* @param[in/out] world Pointer to the world
+* @param[in] hull      The hull to add, must stay valid until it is removed
+* @return Returns the handle of the hull, WORLD2D_INVALID_HANDLE if the world
+*         is full
+*/
+uint32_t world2d_add(world2d_t* world, const hull2d_t* hull)
+{
+    uint32_t handle = world->count;
+
+    if (handle >= world->capacity)
+    {
+        return WORLD2D_INVALID_HANDLE;
+    }
+
+    // the next update sorts the new hull into place
+    world->hulls[handle] = hull;
+    world->leaves[handle] = WORLD2D_INVALID_HANDLE;
+    world2d_hullBox(hull, &world->boxes[handle]);
+    world->order[handle] = handle;
+    world->count += 1;
+
+    return handle;
+}
+
+/**
+* @brief Remove a hull from the world, the hull added last takes over the
+*        handle of the removed hull
+* @param[in/out] world Pointer to the world
+* @param[in] handle    Handle of the hull to remove
+* @return Returns false if handle is not in the world
+*/
+bool_t world2d_remove(world2d_t* world, uint32_t handle)
+{
+    uint32_t i, j, last;
+
+    if (handle >= world->count)
+    {
+        return FALSE;
+    }
+
+    // drop the handle from the sweep order and rename the last handle
+    last = world->count - 1;
+    j = 0;
+    for (i = 0; i < world->count; ++i)
+    {
+        if (world->order[i] != handle)
+        {
+            world->order[j++] = (world->order[i] == last) ?
+                handle : world->order[i];
+        }
+    }
+
+    // the grid keeps its cells until the next update, drop the removed
+    // handle from them and rename the last one
+    for (i = 0; i < world->cellCount; ++i)
+    {
+        if (world->cells[i].handle == handle)
+        {
+            world->cells[i].handle = WORLD2D_INVALID_HANDLE;
+        }
+        else if (world->cells[i].handle == last)
+        {
+            world->cells[i].handle = handle;
+        }
+    }
+
+    // same for the tree, the leaf of the last handle is renamed
+    if (world->leaves[handle] != WORLD2D_INVALID_HANDLE)
+    {
+        world2d_removeLeaf(world, world->leaves[handle]);
+        world2d_freeNode(world, world->leaves[handle]);
+    }
+    world->leaves[handle] = world->leaves[last];
+    if (world->leaves[handle] != WORLD2D_INVALID_HANDLE)
+    {
+        world->nodes[world->leaves[handle]].handle = handle;
+    }
+    world->leaves[last] = WORLD2D_INVALID_HANDLE;
+
+    world->hulls[handle] = world->hulls[last];
+    world->boxes[handle] = world->boxes[last];
+    world->count = last;
+
+    return TRUE;
+}
+
+/**
+* @brief Check if two boxes overlap, empty boxes overlap nothing
+* @param[in] a First box
+* @param[in] b Second box
+* @return Returns true if the boxes overlap or touch
+*/
+static bool_t world2d_overlap(const world2d_box_t* a, const world2d_box_t* b)
+{
+    return a->minX <= b->maxX && b->minX <= a->maxX &&
+           a->minY <= b->maxY && b->minY <= a->maxY;
+}
+
+/**
+* @brief Get the grid cell coordinate of a position along one axis
+* @param[in] v       The position
+* @param[in] invCell Inverse of the cell size
+* @return Returns the cell coordinate
+*/
+static int32_t world2d_cellCoord(float v, float invCell)
+{
+    v = floorf(v * invCell);
+    v = (v < -WORLD2D_MAX_CELL) ? -WORLD2D_MAX_CELL : v;
+    v = (v > WORLD2D_MAX_CELL) ? WORLD2D_MAX_CELL : v;
+    return (int32_t)v;
+}
+
+/**
+* @brief Get the hash bucket of a grid cell
+* @param[in] world Pointer to the world
+* @param[in] x     Cell coordinate along x
+* @param[in] y     Cell coordinate along y
+* @return Returns the bucket index
+*/
+static uint32_t world2d_bucket(const world2d_t* world, int32_t x, int32_t y)
+{
+    uint32_t h = ((uint32_t)x * 73856093U) ^ ((uint32_t)y * 19349663U);
+    return h & (world->bucketCount - 1);
+}
+
+/**
+* @brief Check if a cell is the one reporting an overlap of two boxes, the
+*        cell holding the lowest corner of their intersection
+* @param[in] world Pointer to the world
+* @param[in] cell  The cell
+* @param[in] a     First box
+* @param[in] b     Second box
+* @return Returns true if the overlap belongs to cell
+*/
+static bool_t world2d_ownsOverlap(const world2d_t* world,
+    const world2d_cell_t* cell, const world2d_box_t* a, const world2d_box_t* b)
+{
+    float x = (a->minX > b->minX) ? a->minX : b->minX;
+    float y = (a->minY > b->minY) ? a->minY : b->minY;
+    return world2d_cellCoord(x, world->invCell) == cell->x &&
+           world2d_cellCoord(y, world->invCell) == cell->y;
+}
+
+/**
+* @brief Restore the order of the handles by the left edge of their boxes
+* @param[in/out] world Pointer to the world
+*/
+static void world2d_sortSweep(world2d_t* world)
+{
+    const world2d_box_t* boxes = world->boxes;
+    uint32_t* order = world->order;
+    uint32_t i, j, handle;
+    float minX;
+
+    // insertion sort, nearly linear for a nearly sorted order
+    for (i = 1; i < world->count; ++i)
+    {
+        handle = order[i];
+        minX = boxes[handle].minX;
+        for (j = i; j > 0 && boxes[order[j - 1]].minX > minX; --j)
+        {
+            order[j] = order[j - 1];
+        }
+        order[j] = handle;
+    }
+}
+
+/**
+* @brief Pick the cell size and count the cells covered by the boxes. Cells
+*        are doubled in size until the boxes cover at most
+*        WORLD2D_MAX_CELLS_PER_HULL cells per hull.
+* @param[in/out] world Pointer to the world
+* @return Returns the number of cells covered
+*/
+static uint32_t world2d_countCells(world2d_t* world)
+{
+    const world2d_box_t* box;
+    float size = world->cellSize;
+    float total = 0.0f;
+    uint32_t i, used = 0;
+    uint64_t count, limit;
+
+    if (size <= 0.0f)
+    {
+        for (i = 0; i < world->count; ++i)
+        {
+            box = &world->boxes[i];
+            if (box->minX <= box->maxX)
+            {
+                total += (box->maxX - box->minX > box->maxY - box->minY) ?
+                    box->maxX - box->minX : box->maxY - box->minY;
+                used++;
+            }
+        }
+        size = (used > 0) ? total / (float)used : 0.0f;
+        size = (size > 0.0f) ? size : 1.0f;
+    }
+
+    // a box spans up to 2^31 cells along each axis, so the count of a single
+    // box needs 64 bits and small cells could ask for any amount of memory,
+    // stop counting once the limit is passed, the cells grow anyway
+    limit = (uint64_t)world->count * WORLD2D_MAX_CELLS_PER_HULL;
+    limit = (limit < 0x80000000U) ? limit : 0x80000000U;
+    for (;;)
+    {
+        world->invCell = 1.0f / size;
+        count = 0;
+        for (i = 0; i < world->count && count <= limit; ++i)
+        {
+            box = &world->boxes[i];
+            if (box->minX <= box->maxX)
+            {
+                count += (uint64_t)(
+                    (int64_t)world2d_cellCoord(box->maxX, world->invCell) -
+                    (int64_t)world2d_cellCoord(box->minX, world->invCell) +
+                    1) * (uint64_t)(
+                    (int64_t)world2d_cellCoord(box->maxY, world->invCell) -
+                    (int64_t)world2d_cellCoord(box->minY, world->invCell) +
+                    1);
+            }
+        }
+        if (count <= limit)
+        {
+            return (uint32_t)count;
+        }
+        size *= 2.0f;
+    }
+}
+
+/**
+* @brief Rebuild the grid from the current boxes
+* @param[in/out] world Pointer to the world
+* @return Returns false if the cells or buckets could not be allocated
+*/
+static bool_t world2d_buildGrid(world2d_t* world)
+{
+    const world2d_box_t* box;
+    world2d_cell_t* cells;
+    uint32_t* buckets;
+    uint32_t i, b, bucketCount, count;
+    int32_t x, y, x0, y0, x1, y1;
+
+    count = world2d_countCells(world);
+    if (count > world->cellCapacity)
+    {
+        cells = (world2d_cell_t*)realloc(world->cells,
+            sizeof(world2d_cell_t) * count);
+        if (cells == NULL)
+        {
+            return FALSE;
+        }
+        world->cells = cells;
+        world->cellCapacity = count;
+    }
+
+    // about two buckets per cell keeps the buckets short
+    bucketCount = WORLD2D_MIN_BUCKETS;
+    while (bucketCount < 2 * count && bucketCount < 0x80000000U)
+    {
+        bucketCount <<= 1;
+    }
+    if (bucketCount > world->bucketCount)
+    {
+        buckets = (uint32_t*)realloc(world->buckets,
+            sizeof(uint32_t) * (bucketCount + 1));
+        if (buckets == NULL)
+        {
+            return FALSE;
+        }
+        world->buckets = buckets;
+        world->bucketCount = bucketCount;
+    }
+
+    // counting sort of the cells by bucket, count every bucket, turn the
+    // counts into bucket ends and fill every bucket back to front
+    buckets = world->buckets;
+    memset(buckets, 0, sizeof(uint32_t) * (world->bucketCount + 1));
+    for (b = 0; b < 2; ++b)
+    {
+        for (i = 0; i < world->count; ++i)
+        {
+            box = &world->boxes[i];
+            if (box->minX > box->maxX)
+            {
+                continue;
+            }
+            x0 = world2d_cellCoord(box->minX, world->invCell);
+            y0 = world2d_cellCoord(box->minY, world->invCell);
+            x1 = world2d_cellCoord(box->maxX, world->invCell);
+            y1 = world2d_cellCoord(box->maxY, world->invCell);
+            for (y = y0; y <= y1; ++y)
+            {
+                for (x = x0; x <= x1; ++x)
+                {
+                    if (b == 0)
+                    {
+                        buckets[world2d_bucket(world, x, y)]++;
+                    }
+                    else
+                    {
+                        cells = &world->cells[
+                            --buckets[world2d_bucket(world, x, y)]];
+                        cells->handle = i;
+                        cells->x = x;
+                        cells->y = y;
+                    }
+                }
+            }
+        }
+
+        if (b == 0)
+        {
+            for (i = 1; i < world->bucketCount; ++i)
+            {
+                buckets[i] += buckets[i - 1];
+            }
+            buckets[world->bucketCount] = count;
+        }
+    }
+    world->cellCount = count;
+
+    return TRUE;
+}
+
+/**
+* @brief Refresh the bounding boxes and rebuild the broad phase
+* @param[in/out] world Pointer to the world
+* @return Returns false if the grid could not grow
+*/
+bool_t world2d_update(world2d_t* world)
+{
+    uint32_t i;
+
+    for (i = 0; i < world->count; ++i)
+    {
+        world2d_hullBox(world->hulls[i], &world->boxes[i]);
+    }
+
+    if (world->broadphase == WORLD2D_BROADPHASE_GRID)
+    {
+        if (!world2d_buildGrid(world))
+        {
+            // leave an empty grid behind
+            world2d_setBroadphase(world, WORLD2D_BROADPHASE_GRID);
+            return FALSE;
+        }
+    }
+    else if (world->broadphase == WORLD2D_BROADPHASE_TREE)
+    {
+        for (i = 0; i < world->count; ++i)
+        {
+            world2d_refitLeaf(world, i);
+        }
+    }
+    else
+    {
+        world2d_sortSweep(world);
+    }
+
+    return TRUE;
+}
+
+/**
+* @brief Record a pair of hulls if there is room
+* @param[out] pairs   The pairs array
+* @param[in] maxPairs Size of the pairs array
+* @param[in] found    Number of pairs found so far
+* @param[in] a        First handle
+* @param[in] b        Second handle
+*/
+static void world2d_storePair(world2d_pair_t* pairs, uint32_t maxPairs,
+    uint32_t found, uint32_t a, uint32_t b)
+{
+    if (found < maxPairs)
+    {
+        pairs[found].a = (a < b) ? a : b;
+        pairs[found].b = (a < b) ? b : a;
+    }
+}
+
+/**
+* @brief Narrow phase, test whether two hulls intersect
+* @param[in] world Pointer to the world
+* @param[in] a     First handle
+* @param[in] b     Second handle
+* @return Returns true if the hulls intersect
+*/
+static bool_t world2d_intersect(const world2d_t* world, uint32_t a,
+    uint32_t b)
+{
+    if (world->narrowphase == WORLD2D_NARROWPHASE_GJK)
+    {
+        return hull2d_checkIntersectGjk(world->hulls[a], world->hulls[b],
+            NULL);
+    }
+    return hull2d_checkIntersect(world->hulls[a], world->hulls[b]);
+}
+
+/**
+* @brief Sweep the boxes along x and report the pairs that overlap
+* @param[in] world    Pointer to the world
+* @param[out] pairs   Receives up to maxPairs pairs
+* @param[in] maxPairs Size of the pairs array
+* @param[in] narrow   Only report pairs whose hulls intersect
+* @return Returns the number of pairs found
+*/
+static uint32_t world2d_sweep(const world2d_t* world, world2d_pair_t* pairs,
+    uint32_t maxPairs, bool_t narrow)
+{
+    const world2d_box_t* boxes = world->boxes;
+    const uint32_t* order = world->order;
+    const world2d_box_t *a, *b;
+    uint32_t i, j, found;
+
+    found = 0;
+    for (i = 0; i < world->count; ++i)
+    {
+        a = &boxes[order[i]];
+
+        // every later box starts at or right of a, stop once past its right
+        for (j = i + 1; j < world->count; ++j)
+        {
+            b = &boxes[order[j]];
+            if (b->minX > a->maxX)
+            {
+                break;
+            }
+            if (b->minY > a->maxY || a->minY > b->maxY)
+            {
+                continue;
+            }
+            if (narrow && !world2d_intersect(world, order[i], order[j]))
+            {
+                continue;
+            }
+
+            world2d_storePair(pairs, maxPairs, found, order[i], order[j]);
+            found++;
+        }
+    }
+
+    return found;
+}
+
+/**
+* @brief Walk the grid buckets and report the pairs whose boxes overlap
+* @param[in] world    Pointer to the world
+* @param[out] pairs   Receives up to maxPairs pairs
+* @param[in] maxPairs Size of the pairs array
+* @param[in] narrow   Only report pairs whose hulls intersect
+* @return Returns the number of pairs found
+*/
+static uint32_t world2d_gridPairs(const world2d_t* world, world2d_pair_t* pairs,
+    uint32_t maxPairs, bool_t narrow)
+{
+    const world2d_cell_t *a, *b, *end;
+    const world2d_box_t *boxA, *boxB;
+    uint32_t i, found;
+
+    found = 0;
+    for (i = 0; i < world->bucketCount; ++i)
+    {
+        end = &world->cells[world->buckets[i + 1]];
+        for (a = &world->cells[world->buckets[i]]; a < end; ++a)
+        {
+            if (a->handle == WORLD2D_INVALID_HANDLE)
+            {
+                continue;
+            }
+            boxA = &world->boxes[a->handle];
+            for (b = a + 1; b < end; ++b)
+            {
+                // other cells can share the bucket
+                if (b->x != a->x || b->y != a->y ||
+                    b->handle == WORLD2D_INVALID_HANDLE)
+                {
+                    continue;
+                }
+                boxB = &world->boxes[b->handle];
+                if (!world2d_overlap(boxA, boxB) ||
+                    !world2d_ownsOverlap(world, a, boxA, boxB))
+                {
+                    continue;
+                }
+                if (narrow && !world2d_intersect(world, a->handle, b->handle))
+                {
+                    continue;
+                }
+
+                world2d_storePair(pairs, maxPairs, found, a->handle,
+                    b->handle);
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+* @brief Get the next node of a depth first walk of the tree that skips the
+*        children of a node
+* @param[in] world Pointer to the world
+* @param[in] index The node whose children are skipped
+* @return Returns the next node, invalid once the walk is done
+*/
+static uint32_t world2d_treeSkip(const world2d_t* world, uint32_t index)
+{
+    uint32_t parent;
+
+    // climb until coming up from a first child, its sibling is next
+    while ((parent = world->nodes[index].parent) != WORLD2D_INVALID_HANDLE)
+    {
+        if (world->nodes[parent].child1 == index)
+        {
+            return world->nodes[parent].child2;
+        }
+        index = parent;
+    }
+    return WORLD2D_INVALID_HANDLE;
+}
+
+/**
+* @brief Get the next leaf of the tree whose enlarged box overlaps a box
+* @param[in] world Pointer to the world
+* @param[in] index Node to continue the walk at, the root to start it
+* @param[in] box   The box
+* @return Returns the next leaf, invalid once the walk is done. Continue the
+*         walk at world2d_treeSkip of the leaf.
+*/
+static uint32_t world2d_treeNext(const world2d_t* world, uint32_t index,
+    const world2d_box_t* box)
+{
+    const world2d_node_t* node;
+
+    while (index != WORLD2D_INVALID_HANDLE)
+    {
+        node = &world->nodes[index];
+        if (!world2d_overlap(&node->box, box))
+        {
+            index = world2d_treeSkip(world, index);
+        }
+        else if (node->child1 != WORLD2D_INVALID_HANDLE)
+        {
+            index = node->child1;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return index;
+}
+
+// State of a walk of the tree against itself
+typedef struct world2d_pairWalk_s
+{
+    world2d_pair_t* pairs;
+    uint32_t        maxPairs;
+    uint32_t        found;
+    bool_t          narrow;
+} world2d_pairWalk_t;
+
+/**
+* @brief Report the overlapping pairs with one hull below each of two nodes
+* @param[in] world   Pointer to the world
+* @param[in] indexA  First node
+* @param[in] indexB  Second node
+* @param[in/out] walk The pairs found so far
+*/
+static void world2d_treeCross(const world2d_t* world, uint32_t indexA,
+    uint32_t indexB, world2d_pairWalk_t* walk)
+{
+    const world2d_node_t* a = &world->nodes[indexA];
+    const world2d_node_t* b = &world->nodes[indexB];
+    bool_t leafA = (a->child1 == WORLD2D_INVALID_HANDLE);
+    bool_t leafB = (b->child1 == WORLD2D_INVALID_HANDLE);
+
+    if (!world2d_overlap(&a->box, &b->box))
+    {
+        return;
+    }
+
+    if (leafA && leafB)
+    {
+        if (world2d_overlap(&world->boxes[a->handle],
+                &world->boxes[b->handle]) &&
+            (!walk->narrow || world2d_intersect(world, a->handle,
+                b->handle)))
+        {
+            world2d_storePair(walk->pairs, walk->maxPairs, walk->found,
+                a->handle, b->handle);
+            walk->found++;
+        }
+        return;
+    }
+
+    // descend into the larger node, the smaller one prunes more of it
+    if (leafA || (!leafB &&
+        world2d_perimeter(&b->box) > world2d_perimeter(&a->box)))
+    {
+        world2d_treeCross(world, indexA, b->child1, walk);
+        world2d_treeCross(world, indexA, b->child2, walk);
+    }
+    else
+    {
+        world2d_treeCross(world, a->child1, indexB, walk);
+        world2d_treeCross(world, a->child2, indexB, walk);
+    }
+}
+
+/**
+* @brief Report the overlapping pairs with both hulls below a node
+* @param[in] world   Pointer to the world
+* @param[in] index   The node
+* @param[in/out] walk The pairs found so far
+*/
+static void world2d_treeSelf(const world2d_t* world, uint32_t index,
+    world2d_pairWalk_t* walk)
+{
+    const world2d_node_t* node = &world->nodes[index];
+
+    if (node->child1 == WORLD2D_INVALID_HANDLE)
+    {
+        return;
+    }
+
+    world2d_treeSelf(world, node->child1, walk);
+    world2d_treeSelf(world, node->child2, walk);
+    world2d_treeCross(world, node->child1, node->child2, walk);
+}
+
+/**
+* @brief Walk the tree against itself and report the pairs whose boxes
+*        overlap, the recursion is at most twice the height of the tree deep
+* @param[in] world    Pointer to the world
+* @param[out] pairs   Receives up to maxPairs pairs
+* @param[in] maxPairs Size of the pairs array
+* @param[in] narrow   Only report pairs whose hulls intersect
+* @return Returns the number of pairs found
+*/
+static uint32_t world2d_treePairs(const world2d_t* world, world2d_pair_t* pairs,
+    uint32_t maxPairs, bool_t narrow)
+{
+    world2d_pairWalk_t walk;
+
+    walk.pairs = pairs;
+    walk.maxPairs = maxPairs;
+    walk.found = 0;
+    walk.narrow = narrow;
+
+    if (world->root != WORLD2D_INVALID_HANDLE)
+    {
+        world2d_treeSelf(world, world->root, &walk);
+    }
+    return walk.found;
+}
+
+/**
+* @brief Report the pairs of the selected broad phase
+* @param[in] world    Pointer to the world
+* @param[out] pairs   Receives up to maxPairs pairs
+* @param[in] maxPairs Size of the pairs array
+* @param[in] narrow   Only report pairs whose hulls intersect
+* @return Returns the number of pairs found
+*/
+static uint32_t world2d_pairs(const world2d_t* world, world2d_pair_t* pairs,
+    uint32_t maxPairs, bool_t narrow)
+{
+    switch (world->broadphase)
+    {
+    case WORLD2D_BROADPHASE_GRID:
+        return world2d_gridPairs(world, pairs, maxPairs, narrow);
+    case WORLD2D_BROADPHASE_TREE:
+        return world2d_treePairs(world, pairs, maxPairs, narrow);
+    default:
+        return world2d_sweep(world, pairs, maxPairs, narrow);
+    }
+}
+
+/**
+* @brief Broad phase, find every pair of hulls whose bounding boxes overlap
+* @param[in] world    Pointer to the world
+* @param[out] pairs   Receives up to maxPairs pairs
+* @param[in] maxPairs Size of the pairs array
+* @return Returns the number of pairs found, which may be more than maxPairs
+*/
+uint32_t world2d_findPairs(const world2d_t* world, world2d_pair_t* pairs,
+    uint32_t maxPairs)
+{
+    return world2d_pairs(world, pairs, maxPairs, FALSE);
+}
+
+/**
+* @brief Broad and narrow phase, find every pair of intersecting hulls
+* @param[in] world    Pointer to the world
+* @param[out] pairs   Receives up to maxPairs pairs
+* @param[in] maxPairs Size of the pairs array
+* @return Returns the number of pairs found, which may be more than maxPairs
+*/
+uint32_t world2d_collide(const world2d_t* world, world2d_pair_t* pairs,
+    uint32_t maxPairs)
+{
+    return world2d_pairs(world, pairs, maxPairs, TRUE);
+}
+
+/**
+* @brief Check a hull found by a region or point query
+* @param[in] world  Pointer to the world
+* @param[in] handle Handle of the hull
+* @param[in] region The region searched
+* @param[in] point  The point searched, NULL for a region query
+* @return Returns true if the box overlaps the region and the hull holds the
+*         point
+*/
+static bool_t world2d_accept(const world2d_t* world, uint32_t handle,
+    const world2d_box_t* region, const Point2f* point)
+{
+    return world2d_overlap(&world->boxes[handle], region) &&
+        (point == NULL || hull2d_pointInHull(world->hulls[handle], point));
+}
+
+/**
+* @brief Find every hull whose box overlaps a region and, for point queries,
+*        that holds the point
+* @param[in] world      Pointer to the world
+* @param[in] region     The region to search
+* @param[in] point      The point searched, NULL for a region query
+* @param[out] handles   Receives up to maxHandles handles
+* @param[in] maxHandles Size of the handles array
+* @return Returns the number of hulls found
+*/
+static uint32_t world2d_collect(const world2d_t* world,
+    const world2d_box_t* region, const Point2f* point, uint32_t* handles,
+    uint32_t maxHandles)
+{
+    const world2d_cell_t *cell, *end;
+    uint32_t i, found;
+    int32_t x, y, x0, y0, x1, y1;
+    bool_t scan;
+
+    found = 0;
+    if (region->minX > region->maxX || region->minY > region->maxY)
+    {
+        return found;
+    }
+
+    if (world->broadphase == WORLD2D_BROADPHASE_TREE)
+    {
+        i = world2d_treeNext(world, world->root, region);
+        while (i != WORLD2D_INVALID_HANDLE)
+        {
+            if (world2d_accept(world, world->nodes[i].handle, region, point))
+            {
+                if (found < maxHandles)
+                {
+                    handles[found] = world->nodes[i].handle;
+                }
+                found++;
+            }
+            i = world2d_treeNext(world, world2d_treeSkip(world, i), region);
+        }
+        return found;
+    }
+
+    scan = (world->broadphase != WORLD2D_BROADPHASE_GRID ||
+        world->bucketCount == 0);
+    if (!scan)
+    {
+        x0 = world2d_cellCoord(region->minX, world->invCell);
+        y0 = world2d_cellCoord(region->minY, world->invCell);
+        x1 = world2d_cellCoord(region->maxX, world->invCell);
+        y1 = world2d_cellCoord(region->maxY, world->invCell);
+
+        // a region covering more cells than there are hulls is cheaper to
+        // check against every box
+        scan = ((float)(x1 - x0 + 1) * (float)(y1 - y0 + 1) >
+            (float)world->count);
+    }
+
+    if (scan)
+    {
+        // the sweep order stops the scan at the right edge of the region,
+        // for the grid the order isn't maintained so every box is checked
+        for (i = 0; i < world->count; ++i)
+        {
+            if (world->broadphase == WORLD2D_BROADPHASE_SWEEP &&
+                world->boxes[world->order[i]].minX > region->maxX)
+            {
+                break;
+            }
+            if (world2d_accept(world, world->order[i], region, point))
+            {
+                if (found < maxHandles)
+                {
+                    handles[found] = world->order[i];
+                }
+                found++;
+            }
+        }
+        return found;
+    }
+
+    for (y = y0; y <= y1; ++y)
+    {
+        for (x = x0; x <= x1; ++x)
+        {
+            i = world2d_bucket(world, x, y);
+            end = &world->cells[world->buckets[i + 1]];
+            for (cell = &world->cells[world->buckets[i]]; cell < end; ++cell)
+            {
+                if (cell->x != x || cell->y != y ||
+                    cell->handle == WORLD2D_INVALID_HANDLE ||
+                    !world2d_accept(world, cell->handle, region, point) ||
+                    !world2d_ownsOverlap(world, cell,
+                        &world->boxes[cell->handle], region))
+                {
+                    continue;
+                }
+                if (found < maxHandles)
+                {
+                    handles[found] = cell->handle;
+                }
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+* @brief Find every hull whose bounding box overlaps a region
+* @param[in] world      Pointer to the world
+* @param[in] region     The region to search
+* @param[out] handles   Receives up to maxHandles handles
+* @param[in] maxHandles Size of the handles array
+* @return Returns the number of hulls found, which may be more than maxHandles
+*/
+uint32_t world2d_query(const world2d_t* world, const world2d_box_t* region,
+    uint32_t* handles, uint32_t maxHandles)
+{
+    return world2d_collect(world, region, NULL, handles, maxHandles);
+}
+
+/**
+* @brief Find every hull containing a point
+* @param[in] world      Pointer to the world
+* @param[in] p          The point
+* @param[out] handles   Receives up to maxHandles handles
+* @param[in] maxHandles Size of the handles array
+* @return Returns the number of hulls found, which may be more than maxHandles
+*/
+uint32_t world2d_queryPoint(const world2d_t* world, const Point2f* p,
+    uint32_t* handles, uint32_t maxHandles)
+{
+    world2d_box_t region;
+
+    region.minX = p->x;
+    region.minY = p->y;
+    region.maxX = p->x;
+    region.maxY = p->y;
+
+    return world2d_collect(world, &region, p, handles, maxHandles);
+}
+
+/**
+* @brief Check if a segment passes through a box before a given fraction
+* @param[in] box         The box
+* @param[in] from        Start of the segment
+* @param[in] delta       End of the segment minus its start
+* @param[in] maxFraction Only the segment up to this fraction is tested
+* @return Returns true if the segment overlaps the box
+*/
+static bool_t world2d_rayBox(const world2d_box_t* box, const Point2f* from,
+    const Point2f* delta, float maxFraction)
+{
+    const float lo[2] = { box->minX, box->minY };
+    const float hi[2] = { box->maxX, box->maxY };
+    const float start[2] = { from->x, from->y };
+    const float step[2] = { delta->x, delta->y };
+    float enter = 0.0f;
+    float exit = maxFraction;
+    float t0, t1, swap;
+    uint32_t k;
+
+    // clip the segment against the slab of every axis
+    for (k = 0; k < 2; ++k)
+    {
+        if (step[k] == 0.0f)
+        {
+            if (start[k] < lo[k] || start[k] > hi[k])
+            {
+                return FALSE;
+            }
+            continue;
+        }
+
+        t0 = (lo[k] - start[k]) / step[k];
+        t1 = (hi[k] - start[k]) / step[k];
+        if (t0 > t1)
+        {
+            swap = t0;
+            t0 = t1;
+            t1 = swap;
+        }
+        enter = (t0 > enter) ? t0 : enter;
+        exit = (t1 < exit) ? t1 : exit;
+        if (enter > exit)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+* @brief Check if a segment hits a hull closer than the closest hit so far
+* @param[in] world     Pointer to the world
+* @param[in] handle    Handle of the hull
+* @param[in] from      Start of the segment
+* @param[in] to        End of the segment
+* @param[in] delta     End of the segment minus its start
+* @param[in/out] hit   Handle of the closest hull hit so far, updated
+* @param[in/out] best  Fraction of the closest hit so far, updated
+*/
+static void world2d_rayHull(const world2d_t* world, uint32_t handle,
+    const Point2f* from, const Point2f* to, const Point2f* delta,
+    uint32_t* hit, float* best)
+{
+    const world2d_box_t* box = &world->boxes[handle];
+    float t;
+
+    if (box->minX <= box->maxX &&
+        world2d_rayBox(box, from, delta, *best) &&
+        hull2d_raycast(world->hulls[handle], from, to, &t) &&
+        (*hit == WORLD2D_INVALID_HANDLE || t < *best))
+    {
+        *best = t;
+        *hit = handle;
+    }
+}
+
+/**
+* @brief Find the first hull hit by a segment
+* @param[in] world     Pointer to the world
+* @param[in] from      Start of the segment
+* @param[in] to        End of the segment
+* @param[out] fraction Receives the position of the hit along the segment
+* @return Returns the handle of the hull hit, WORLD2D_INVALID_HANDLE if the
+*         segment hits nothing
+*/
+uint32_t world2d_raycast(const world2d_t* world, const Point2f* from,
+    const Point2f* to, float* fraction)
+{
+    const world2d_node_t* node;
+    Point2f delta;
+    uint32_t i, hit;
+    float best;
+
+    delta.x = to->x - from->x;
+    delta.y = to->y - from->y;
+    best = 1.0f;
+    hit = WORLD2D_INVALID_HANDLE;
+
+    if (world->broadphase == WORLD2D_BROADPHASE_TREE)
+    {
+        // skip every node the segment misses before the closest hit so far
+        i = world->root;
+        while (i != WORLD2D_INVALID_HANDLE)
+        {
+            node = &world->nodes[i];
+            if (!world2d_rayBox(&node->box, from, &delta, best))
+            {
+                i = world2d_treeSkip(world, i);
+            }
+            else if (node->child1 != WORLD2D_INVALID_HANDLE)
+            {
+                i = node->child1;
+            }
+            else
+            {
+                world2d_rayHull(world, node->handle, from, to, &delta, &hit,
+                    &best);
+                i = world2d_treeSkip(world, i);
+            }
+        }
+    }
+    else
+    {
+        for (i = 0; i < world->count; ++i)
+        {
+            world2d_rayHull(world, i, from, to, &delta, &hit, &best);
+        }
+    }
+
+    if (hit != WORLD2D_INVALID_HANDLE)
+    {
+        *fraction = best;
+    }
+    return hit;
+}
@@ -0,0 +1,232 @@
+#include "hull2d.h"
+
+#include <stdio.h>
+
+/**
+* Regression test for the angular sort of Graham's scan, on lists long enough
+* for the radix sort and short enough for the comparison sort.
+*
+* Points on a small integer lattice repeat and share many rays from the
+* lowest point, their orientations are exact so the boundary must match the
+* monotone chain vertex for vertex. Thin unit scale clouds put many points
+* within rounding of the same angle, every point must end up inside the hull.
+*
+* Build from the repository root with
+*   cc -O2 -Iinc test/graham.c src/hull2d.c src/stack.c src/pool.c -lpthread -lm
+* The program returns a non-zero exit code if any hull fails.
+*/
+
+// Number of point sets of each kind
+#define GRAHAM_SETS        (2000U)
+
+// Sizes of the point sets, half of them at least the radix sort threshold
+#define GRAHAM_MIN_POINTS  (50U)
+#define GRAHAM_MAX_POINTS  (2000U)
+#define GRAHAM_RADIX_SIZE  (513U)
+
+// Widths of the lattices the points are taken from
+#define GRAHAM_MIN_LATTICE (4U)
+#define GRAHAM_MAX_LATTICE (64U)
+
+// Perpendicular noise of the thin clouds is 1e-3 to 1e-4
+#define GRAHAM_NOISE_EXP   (2U)
+
+// A point further than this from the boundary is a miss
+#define GRAHAM_MISS_TOL    (1e-3)
+
+static uint64_t grahamState = 2463534242ULL;
+
+/**
+* @brief Uniform random number in [0, 1), xorshift so every platform builds
+*        the same point sets
+*/
+static double graham_rand(void)
+{
+    grahamState ^= grahamState << 13;
+    grahamState ^= grahamState >> 7;
+    grahamState ^= grahamState << 17;
+    return (double)(grahamState >> 11) / 9007199254740992.0;
+}
+
+/**
+* @brief Pick the size of a point set, every other set takes the radix sort
+* @param[in] set Index of the set
+*/
+static uint32_t graham_count(uint32_t set)
+{
+    uint32_t lo = (set & 1U) ? GRAHAM_RADIX_SIZE : GRAHAM_MIN_POINTS;
+    uint32_t hi = (set & 1U) ? GRAHAM_MAX_POINTS : GRAHAM_RADIX_SIZE - 1U;
+    return lo + (uint32_t)(graham_rand() * (hi - lo + 1));
+}
+
+/**
+* @brief Distance from a point to the segment ab
+* @param[in] a Start of the segment
+* @param[in] b End of the segment
+* @param[in] p The point
+*/
+static double graham_distance(const Point2f* a, const Point2f* b,
+    const Point2f* p)
+{
+    double dx, dy, px, py, len2, t;
+
+    dx = (double)b->x - a->x;
+    dy = (double)b->y - a->y;
+    px = (double)p->x - a->x;
+    py = (double)p->y - a->y;
+    len2 = dx * dx + dy * dy;
+    t = (len2 > 0.0) ? (px * dx + py * dy) / len2 : 0.0;
+    t = (t < 0.0) ? 0.0 : ((t > 1.0) ? 1.0 : t);
+    px -= t * dx;
+    py -= t * dy;
+
+    return sqrt(px * px + py * py);
+}
+
+/**
+* @brief Check that no point of a computed hull is outside its boundary
+* @param[in] hull Pointer to a computed hull
+* @return Returns true if every point is inside the hull or no further than
+*         GRAHAM_MISS_TOL from its boundary
+*/
+static bool_t graham_holdsPoints(const hull2d_t* hull)
+{
+    const Point2f *a, *b, *c;
+    double dist, nearest;
+    uint32_t h, i, k;
+    bool_t outside;
+
+    h = hull->boundaryCount;
+    for (i = 0; i < hull->pointCount; ++i)
+    {
+        c = &hull->points[i];
+        outside = FALSE;
+        nearest = DBL_MAX;
+        for (k = 0; k < h; ++k)
+        {
+            a = &hull->points[hull->boundaryIdx[k].pointIdx];
+            b = &hull->points[hull->boundaryIdx[(k + 1) % h].pointIdx];
+            if (((double)b->x - a->x) * ((double)c->y - a->y) -
+                ((double)c->x - a->x) * ((double)b->y - a->y) < 0.0)
+            {
+                outside = TRUE;
+            }
+            dist = graham_distance(a, b, c);
+            nearest = (dist < nearest) ? dist : nearest;
+        }
+        if (outside && nearest > GRAHAM_MISS_TOL)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+* @brief Check that two computed hulls have the same boundary vertices in the
+*        same order, repeated points may be picked by either index
+* @param[in] ha The first hull
+* @param[in] hb The second hull
+*/
+static bool_t graham_sameBoundary(const hull2d_t* ha, const hull2d_t* hb)
+{
+    const Point2f *a, *b;
+    uint32_t k;
+
+    if (ha->boundaryCount != hb->boundaryCount)
+    {
+        return FALSE;
+    }
+
+    for (k = 0; k < ha->boundaryCount; ++k)
+    {
+        a = &ha->points[ha->boundaryIdx[k].pointIdx];
+        b = &hb->points[hb->boundaryIdx[k].pointIdx];
+        if (a->x != b->x || a->y != b->y)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+int main(void)
+{
+    static Point2f points[GRAHAM_MAX_POINTS];
+    hull2d_context_t context;
+    hull2d_t graham, monotone;
+    uint32_t set, count, width, i, latticeFailed, cloudFailed;
+    double ax, ay, dx, dy, t, s, noise;
+
+    if (!hull2d_init(&graham, GRAHAM_MAX_POINTS) ||
+        !hull2d_init(&monotone, GRAHAM_MAX_POINTS) ||
+        !hull2d_initContext(&context))
+    {
+        printf("out of memory\n");
+        return 2;
+    }
+    hull2d_setEngine(&monotone, HULL2D_ENGINE_MONOTONE);
+
+    // lattice points, Graham's scan must agree with the monotone chain
+    latticeFailed = 0;
+    for (set = 0; set < GRAHAM_SETS; ++set)
+    {
+        count = graham_count(set);
+        width = GRAHAM_MIN_LATTICE + (uint32_t)(graham_rand() *
+            (GRAHAM_MAX_LATTICE - GRAHAM_MIN_LATTICE + 1));
+        for (i = 0; i < count; ++i)
+        {
+            points[i].x = (float)(uint32_t)(graham_rand() * width);
+            points[i].y = (float)(uint32_t)(graham_rand() * width);
+        }
+
+        hull2d_clear(&graham);
+        hull2d_clear(&monotone);
+        (void)hull2d_addPoints(&graham, points, count);
+        (void)hull2d_addPoints(&monotone, points, count);
+        if (hull2d_computeHull(&graham, &context) !=
+            hull2d_computeHull(&monotone, &context) ||
+            (!graham.dirty && !graham_sameBoundary(&graham, &monotone)))
+        {
+            latticeFailed++;
+        }
+    }
+
+    // thin clouds along a random unit segment
+    cloudFailed = 0;
+    for (set = 0; set < GRAHAM_SETS; ++set)
+    {
+        count = graham_count(set);
+        noise = pow(10.0, -3.0 - (double)(set % GRAHAM_NOISE_EXP));
+        ax = graham_rand();
+        ay = graham_rand();
+        dx = graham_rand() - ax;
+        dy = graham_rand() - ay;
+        for (i = 0; i < count; ++i)
+        {
+            t = graham_rand();
+            s = (2.0 * graham_rand() - 1.0) * noise;
+            points[i].x = (float)(ax + t * dx - s * dy);
+            points[i].y = (float)(ay + t * dy + s * dx);
+        }
+
+        hull2d_clear(&graham);
+        (void)hull2d_addPoints(&graham, points, count);
+        if (hull2d_computeHull(&graham, &context) &&
+            !graham_holdsPoints(&graham))
+        {
+            cloudFailed++;
+        }
+    }
+
+    printf("lattice      failed %5u\n", latticeFailed);
+    printf("thin cloud   failed %5u\n", cloudFailed);
+
+    hull2d_destroyContext(&context);
+    hull2d_destroy(&monotone);
+    hull2d_destroy(&graham);
+
+    return (latticeFailed == 0 && cloudFailed == 0) ? 0 : 1;
+}
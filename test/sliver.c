@@ -0,0 +1,298 @@
+#include "hull2d.h"
+
+#include <stdio.h>
+
+/**
+* Regression test for near-collinear "sliver" point sets. Points are scattered
+* along a random segment with a tiny perpendicular noise, so almost every turn
+* of the hull is within FLT_EPSILON of straight. Batch construction, vertex
+* removal and incremental insertion must still return a boundary that goes
+* round once and holds every input point.
+*
+* Build from the repository root with
+*   cc -O2 -Iinc test/sliver.c src/hull2d.c src/stack.c src/pool.c -lpthread -lm
+* The program returns a non-zero exit code if any hull fails.
+*/
+
+#ifndef M_PI
+#define M_PI (3.14159265358979323846)
+#endif
+
+// Number of point sets built for every engine
+#define SLIVER_SETS       (6000U)
+
+// Size of the point sets, the noise is 1e-3 to 1e-8 of the segment length
+#define SLIVER_MIN_POINTS (3U)
+#define SLIVER_MAX_POINTS (2000U)
+#define SLIVER_NOISE_EXP  (6U)
+
+// Boundary vertices removed from every hull by the removal test
+#define SLIVER_REMOVALS   (8U)
+
+// The engines call a turn straight when twice its area is within FLT_EPSILON,
+// next to a short edge that leaves a point up to FLT_EPSILON / length outside.
+// A point further than this from the boundary is a miss.
+#define SLIVER_MISS_TOL   (1e-3)
+
+// Slack on the sum of the turns of one lap
+#define SLIVER_LAP_TOL    (1e-3)
+
+static const char* const sliverEngineName[] =
+    { "graham", "monotone", "chan", "quickhull" };
+
+typedef struct sliver_result_s
+{
+    uint32_t failed;   // hulls that wrap more than once or miss a point
+    double   worst;    // farthest a point was left outside a hull
+} sliver_result_t;
+
+static uint64_t sliverState = 88172645463325252ULL;
+
+/**
+* @brief Uniform random number in [0, 1), xorshift so every platform builds
+*        the same point sets
+*/
+static double sliver_rand(void)
+{
+    sliverState ^= sliverState << 13;
+    sliverState ^= sliverState >> 7;
+    sliverState ^= sliverState << 17;
+    return (double)(sliverState >> 11) / 9007199254740992.0;
+}
+
+/**
+* @brief Fill points with a sliver along a random segment
+* @param[out] points Receives the points
+* @param[in] count   Number of points
+* @param[in] noise   Perpendicular noise as a fraction of the segment length
+*/
+static void sliver_make(Point2f* points, uint32_t count, double noise)
+{
+    double ax, ay, dx, dy, t, s;
+    uint32_t i;
+
+    ax = sliver_rand() * 100.0;
+    ay = sliver_rand() * 100.0;
+    dx = sliver_rand() * 100.0 - ax;
+    dy = sliver_rand() * 100.0 - ay;
+
+    for (i = 0; i < count; ++i)
+    {
+        t = sliver_rand();
+        s = (2.0 * sliver_rand() - 1.0) * noise;
+        points[i].x = (float)(ax + t * dx - s * dy);
+        points[i].y = (float)(ay + t * dy + s * dx);
+    }
+}
+
+/**
+* @brief Distance from a point to the segment ab
+* @param[in] a Start of the segment
+* @param[in] b End of the segment
+* @param[in] p The point
+*/
+static double sliver_distance(const Point2f* a, const Point2f* b,
+    const Point2f* p)
+{
+    double dx, dy, px, py, len2, t;
+
+    dx = (double)b->x - a->x;
+    dy = (double)b->y - a->y;
+    px = (double)p->x - a->x;
+    py = (double)p->y - a->y;
+    len2 = dx * dx + dy * dy;
+    t = (len2 > 0.0) ? (px * dx + py * dy) / len2 : 0.0;
+    t = (t < 0.0) ? 0.0 : ((t > 1.0) ? 1.0 : t);
+    px -= t * dx;
+    py -= t * dy;
+
+    return sqrt(px * px + py * py);
+}
+
+/**
+* @brief Check a computed hull against the points it was built from
+* @param[in] hull   Pointer to a computed hull
+* @param[out] worst Receives how far the farthest point is outside the hull
+* @return Returns true if the boundary goes round once and no point is more
+*         than SLIVER_MISS_TOL outside it
+*/
+static bool_t sliver_check(const hull2d_t* hull, double* worst)
+{
+    const Point2f *a, *b, *c;
+    double turn, dist, nearest;
+    uint32_t h, i, k;
+    bool_t outside;
+
+    h = hull->boundaryCount;
+    *worst = 0.0;
+    if (h < 3)
+    {
+        return FALSE;
+    }
+
+    // The turns add up to one lap even with right turns counted as left, so
+    // a tip that turns back by a hair passes and a zigzag does not
+    turn = 0.0;
+    for (k = 0; k < h; ++k)
+    {
+        a = &hull->points[hull->boundaryIdx[k].pointIdx];
+        b = &hull->points[hull->boundaryIdx[(k + 1) % h].pointIdx];
+        c = &hull->points[hull->boundaryIdx[(k + 2) % h].pointIdx];
+        turn += fabs(atan2(
+            ((double)b->x - a->x) * ((double)c->y - b->y) -
+            ((double)b->y - a->y) * ((double)c->x - b->x),
+            ((double)b->x - a->x) * ((double)c->x - b->x) +
+            ((double)b->y - a->y) * ((double)c->y - b->y)));
+    }
+
+    // a point right of any edge is outside, by its distance to the boundary
+    for (i = 0; i < hull->pointCount; ++i)
+    {
+        c = &hull->points[i];
+        outside = FALSE;
+        nearest = DBL_MAX;
+        for (k = 0; k < h; ++k)
+        {
+            a = &hull->points[hull->boundaryIdx[k].pointIdx];
+            b = &hull->points[hull->boundaryIdx[(k + 1) % h].pointIdx];
+            if (((double)b->x - a->x) * ((double)c->y - a->y) -
+                ((double)c->x - a->x) * ((double)b->y - a->y) < 0.0)
+            {
+                outside = TRUE;
+            }
+            dist = sliver_distance(a, b, c);
+            nearest = (dist < nearest) ? dist : nearest;
+        }
+        if (outside && nearest > *worst)
+        {
+            *worst = nearest;
+        }
+    }
+
+    return fabs(turn - 2.0 * M_PI) <= SLIVER_LAP_TOL &&
+        *worst <= SLIVER_MISS_TOL;
+}
+
+/**
+* @brief Count a hull in a result
+* @param[in/out] result The result to update
+* @param[in] ok         Whether the hull passed
+* @param[in] worst      How far the farthest point is outside the hull
+*/
+static void sliver_record(sliver_result_t* result, bool_t ok, double worst)
+{
+    if (!ok)
+    {
+        result->failed++;
+    }
+    if (worst > result->worst)
+    {
+        result->worst = worst;
+    }
+}
+
+/**
+* @brief Print a result and return whether it passed
+* @param[in] test   Name of the test
+* @param[in] engine The engine the hulls were built with
+* @param[in] result The result
+*/
+static bool_t sliver_report(const char* test, hull2d_engine_t engine,
+    const sliver_result_t* result)
+{
+    printf("%-12s %-10s failed %5u, worst miss %g\n", test,
+        sliverEngineName[engine], result->failed, result->worst);
+    return result->failed == 0;
+}
+
+int main(void)
+{
+    static Point2f points[SLIVER_MAX_POINTS];
+    sliver_result_t batch, incremental, removal;
+    hull2d_context_t context;
+    hull2d_engine_t engine;
+    hull2d_t hull;
+    uint32_t set, count, first, i, r;
+    double noise, worst;
+    bool_t passed = TRUE, ok;
+
+    if (!hull2d_init(&hull, SLIVER_MAX_POINTS) ||
+        !hull2d_initContext(&context))
+    {
+        printf("out of memory\n");
+        return 2;
+    }
+
+    for (engine = HULL2D_ENGINE_GRAHAM; engine <= HULL2D_ENGINE_QUICKHULL;
+        ++engine)
+    {
+        memset(&batch, 0, sizeof(batch));
+        memset(&incremental, 0, sizeof(incremental));
+        memset(&removal, 0, sizeof(removal));
+        hull2d_setEngine(&hull, engine);
+
+        for (set = 0; set < SLIVER_SETS; ++set)
+        {
+            count = SLIVER_MIN_POINTS + (uint32_t)(sliver_rand() *
+                (SLIVER_MAX_POINTS - SLIVER_MIN_POINTS + 1));
+            noise = pow(10.0, -3.0 - (double)(set % SLIVER_NOISE_EXP));
+            sliver_make(points, count, noise);
+
+            // batch construction
+            hull2d_setIncremental(&hull, FALSE);
+            hull2d_clear(&hull);
+            (void)hull2d_addPoints(&hull, points, count);
+            if (!hull2d_computeHull(&hull, &context))
+            {
+                // the points have no interior, nothing to check
+                continue;
+            }
+            ok = sliver_check(&hull, &worst);
+            sliver_record(&batch, ok, worst);
+
+            // remove boundary vertices one at a time
+            for (r = 0; r < SLIVER_REMOVALS; ++r)
+            {
+                i = hull.boundaryIdx[(uint32_t)(sliver_rand() *
+                    hull.boundaryCount)].pointIdx;
+                (void)hull2d_removePoint(&hull, i);
+                if (!hull2d_computeHull(&hull, &context))
+                {
+                    break;
+                }
+                ok = sliver_check(&hull, &worst);
+                sliver_record(&removal, ok, worst);
+            }
+
+            // insert the points one at a time into the hull of the first few
+            hull2d_clear(&hull);
+            hull2d_setIncremental(&hull, TRUE);
+            for (first = 0; first < count; ++first)
+            {
+                (void)hull2d_addPoint(&hull, &points[first]);
+                if (first >= 2 && hull2d_computeHull(&hull, &context))
+                {
+                    break;
+                }
+            }
+            for (i = first + 1; i < count; ++i)
+            {
+                (void)hull2d_addPoint(&hull, &points[i]);
+            }
+            if (first < count)
+            {
+                ok = sliver_check(&hull, &worst);
+                sliver_record(&incremental, ok, worst);
+            }
+        }
+
+        passed = sliver_report("batch", engine, &batch) && passed;
+        passed = sliver_report("removal", engine, &removal) && passed;
+        passed = sliver_report("incremental", engine, &incremental) && passed;
+    }
+
+    hull2d_destroyContext(&context);
+    hull2d_destroy(&hull);
+
+    return passed ? 0 : 1;
+}